@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "barrett.h"
+#include "bench.h"
+#include "bignum.h"
+#include "montgomery.h"
+
+static void bench_fill(bignum_t *bignum, const size_t words) {
+    bn_init(bignum, BN_ARRAY_SIZE);
+    for (size_t i = 0; i < words; ++i) {
+        for (size_t j = 0; j < BN_WORD_SIZE; ++j) {
+            (*bignum)[i] = ((*bignum)[i] << 8) | (BN_DTYPE)(rand() & 0xFF);
+        }
+    }
+    (*bignum)[words - 1] |= (BN_DTYPE)1 << (BN_WORD_SIZE * 8 - 1);
+}
+
+// Разовые приведения без домена: bn_mod, Барретт и Монтгомери с переводом в домен
+int main(void) {
+    printf("BN_WORD_SIZE = %d\n", BN_WORD_SIZE);
+    srand(1);
+
+    for (size_t bits = 512; bits <= KEY_SIZE; bits <<= 1) {
+        const size_t words = BN_BITS_TO_WORDS(bits);
+        static bignum_t mod, val, a, b, a_montg, res;
+        static barrett_t ctx;
+        static montg_t md;
+        char name[64];
+
+        bench_fill(&mod, words);
+        mod[0] |= 1;
+        bench_fill(&val, words * 2);
+        bench_fill(&a, words);
+        bench_fill(&b, words);
+        bn_mod(&val, &mod, &val, words * 2);
+        bn_karatsuba(&val, &val, &val, words * 2);
+        bn_mod(&a, &mod, &a, words * 2);
+        bn_mod(&b, &mod, &b, words * 2);
+
+        snprintf(name, sizeof(name), "barrett_init %zu", bits);
+        BENCH_RUN(name, barrett_init(&ctx, &mod));
+
+        snprintf(name, sizeof(name), "montg_init %zu", bits);
+        BENCH_RUN(name, montg_init(&md, &mod));
+
+        snprintf(name, sizeof(name), "bn_mod %zu/%zu", bits * 2, bits);
+        BENCH_RUN(name, bn_mod(&val, &mod, &res, words * 2));
+
+        snprintf(name, sizeof(name), "barrett_reduce %zu/%zu", bits * 2, bits);
+        BENCH_RUN(name, barrett_reduce(&ctx, &val, &res));
+
+        // a * b mod m для чисел в обычном виде
+        snprintf(name, sizeof(name), "mulmod bn_karatsuba+bn_mod %zu", bits);
+        BENCH_RUN(name, {
+            bn_karatsuba(&a, &b, &res, words * 2);
+            bn_mod(&res, &mod, &res, words * 2);
+        });
+
+        snprintf(name, sizeof(name), "mulmod barrett %zu", bits);
+        BENCH_RUN(name, barrett_mulmod(&ctx, &a, &b, &res));
+
+        // a * R, затем a * R * b / R = a * b
+        snprintf(name, sizeof(name), "mulmod montg transform+mul %zu", bits);
+        BENCH_RUN(name, {
+            montg_transform(&md, &a, &a_montg);
+            montg_mul(&md, &a_montg, &b, &res);
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,62 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <time.h>
+
+// Минимальное время замера одной операции, секунды
+#ifndef BENCH_MIN_TIME
+    #define BENCH_MIN_TIME 1.0
+#endif
+
+static inline double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Повторяет body, пока не наберётся BENCH_MIN_TIME, и печатает время одной итерации
+#define BENCH_RUN(name, body)                                                   \
+    do {                                                                        \
+        size_t bench_iters = 0;                                                 \
+        double bench_beg = bench_now(), bench_elapsed;                          \
+        do {                                                                    \
+            body;                                                               \
+            ++bench_iters;                                                      \
+            bench_elapsed = bench_now() - bench_beg;                            \
+        } while (bench_elapsed < BENCH_MIN_TIME);                               \
+        printf("%-40s %12.3f us/op %12.1f op/s\n", name,                        \
+               bench_elapsed / bench_iters * 1e6, bench_iters / bench_elapsed); \
+    } while (0)
+
+// То же с пропускной способностью: bytes - объём данных одной итерации
+#define BENCH_RUN_BYTES(name, bytes, body)                                      \
+    do {                                                                        \
+        size_t bench_iters = 0;                                                 \
+        double bench_beg = bench_now(), bench_elapsed;                          \
+        do {                                                                    \
+            body;                                                               \
+            ++bench_iters;                                                      \
+            bench_elapsed = bench_now() - bench_beg;                            \
+        } while (bench_elapsed < BENCH_MIN_TIME);                               \
+        printf("%-40s %12.3f us/op %12.1f MB/s\n", name,                        \
+               bench_elapsed / bench_iters * 1e6,                               \
+               (double)(bytes) * bench_iters / bench_elapsed / 1e6);            \
+    } while (0)
+
+// То же с числом обработанных элементов: items - элементов за итерацию (подписей, сообщений)
+#define BENCH_RUN_ITEMS(name, items, body)                                      \
+    do {                                                                        \
+        size_t bench_iters = 0;                                                 \
+        double bench_beg = bench_now(), bench_elapsed;                          \
+        do {                                                                    \
+            body;                                                               \
+            ++bench_iters;                                                      \
+            bench_elapsed = bench_now() - bench_beg;                            \
+        } while (bench_elapsed < BENCH_MIN_TIME);                               \
+        printf("%-40s %12.3f us/op %12.1f items/s\n", name,                     \
+               bench_elapsed / bench_iters * 1e6,                               \
+               (double)(items) * bench_iters / bench_elapsed);                  \
+    } while (0)
+
+#endif // BENCH_H
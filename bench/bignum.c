@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "bignum.h"
+
+static void bench_fill(bignum_t *bignum, const size_t words) {
+    bn_init(bignum, BN_ARRAY_SIZE);
+    for (size_t i = 0; i < words; ++i) {
+        for (size_t j = 0; j < BN_WORD_SIZE; ++j) {
+            (*bignum)[i] = ((*bignum)[i] << 8) | (BN_DTYPE)(rand() & 0xFF);
+        }
+    }
+    (*bignum)[words - 1] |= (BN_DTYPE)1 << (BN_WORD_SIZE * 8 - 1);
+}
+
+int main(void) {
+    printf("BN_WORD_SIZE = %d, BN_KARATSUBA_CUTOFF = %d\n", BN_WORD_SIZE, BN_KARATSUBA_CUTOFF);
+    printf("frame stack = %zu bytes, scratch (mul %d bits) = %zu bytes\n", bn_karatsuba_stack_size(), KEY_SIZE,
+           bn_karatsuba_scratch_size(BN_ARRAY_SIZE) * BN_WORD_SIZE);
+    srand(1);
+
+    for (size_t bits = 512; bits <= KEY_SIZE; bits <<= 1) {
+        const size_t words = BN_BITS_TO_WORDS(bits);
+        const size_t size = words * 2;
+        bignum_t num, den, q, r;
+        char name[64];
+
+        bench_fill(&num, words);
+        bench_fill(&den, words);
+
+        // Шестнадцатеричный вид: bytes - длина строки
+        char hex[BN_BYTE_SIZE * 2 + 1];
+        bn_to_string(&num, hex, sizeof(hex));
+        const size_t hex_len = strlen(hex);
+
+        snprintf(name, sizeof(name), "bn_to_string %zu", bits);
+        BENCH_RUN_BYTES(name, hex_len, bn_to_string(&num, hex, sizeof(hex)));
+
+        snprintf(name, sizeof(name), "bn_from_string %zu", bits);
+        BENCH_RUN_BYTES(name, hex_len, bn_from_string(&q, hex, hex_len));
+
+        snprintf(name, sizeof(name), "bn_karatsuba %zux%zu", bits, bits);
+        BENCH_RUN(name, bn_karatsuba(&num, &den, &q, size));
+
+        // Деление 2k-битного числа на k-битное, как при приведении по модулю
+        bench_fill(&num, size);
+        bench_fill(&den, words);
+
+        snprintf(name, sizeof(name), "bn_div %zu/%zu", bits * 2, bits);
+        BENCH_RUN(name, bn_div(&num, &den, &q, size));
+
+        snprintf(name, sizeof(name), "bn_mod %zu/%zu", bits * 2, bits);
+        BENCH_RUN(name, bn_mod(&num, &den, &r, size));
+
+        snprintf(name, sizeof(name), "bn_divmod %zu/%zu", bits * 2, bits);
+        BENCH_RUN(name, bn_divmod(&num, &den, &q, &r, size));
+
+        // Один проход на любой сдвиг против побитового сдвига (по проходу на бит)
+        snprintf(name, sizeof(name), "bn_lshift %zu by 67", bits * 2);
+        BENCH_RUN(name, bn_lshift(&num, &q, 67, size));
+
+        snprintf(name, sizeof(name), "bn_rshift %zu by 67", bits * 2);
+        BENCH_RUN(name, bn_rshift(&num, &q, 67, size));
+
+        snprintf(name, sizeof(name), "bn_lshift %zu by 1 x67", bits * 2);
+        BENCH_RUN(name, for (int k = 0; k < 67; ++k) { bn_lshift(&num, &num, 1, size); });
+    }
+
+    return 0;
+}
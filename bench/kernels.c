@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "bignum_kernels.h"
+
+#if defined(__x86_64__)
+    #include <x86intrin.h>
+    #define BENCH_TICKS() __rdtsc()
+    #define BENCH_TICKS_NAME "cycles"
+#else
+    #define BENCH_TICKS() (unsigned long long)(bench_now() * 1e9)
+    #define BENCH_TICKS_NAME "ns"
+#endif
+
+#define BENCH_REPEAT 100000
+
+// Тактов (TSC) на разряд: лучший из нескольких замеров по BENCH_REPEAT вызовов
+#define BENCH_PER_LIMB(name, n, body)                                                  \
+    do {                                                                               \
+        double best = 1e30;                                                            \
+        for (int round = 0; round < 5; ++round) {                                      \
+            const unsigned long long beg = BENCH_TICKS();                              \
+            for (int rep = 0; rep < BENCH_REPEAT; ++rep) {                             \
+                body;                                                                  \
+            }                                                                          \
+            const double ticks = (double)(BENCH_TICKS() - beg) / BENCH_REPEAT / (n);   \
+            best = ticks < best ? ticks : best;                                        \
+        }                                                                              \
+        printf("%-40s %8.2f %s/limb\n", name, best, BENCH_TICKS_NAME);                 \
+    } while (0)
+
+static void bench_kernels(const bn_kernels_t *kernels) {
+    static BN_DTYPE a[256], b[256], res[257];
+    for (size_t i = 0; i < 256; ++i) {
+        a[i] = (BN_DTYPE)rand() * (BN_DTYPE)rand();
+        b[i] = (BN_DTYPE)rand() * (BN_DTYPE)rand();
+        res[i] = (BN_DTYPE)rand();
+    }
+
+    const size_t sizes[] = {8, 32, 64, 256};
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); ++k) {
+        const size_t n = sizes[k];
+        char name[64];
+        volatile BN_DTYPE sink = 0;
+
+        snprintf(name, sizeof(name), "%s add_n %zu", kernels->name, n);
+        BENCH_PER_LIMB(name, n, sink += kernels->add_n(res, a, b, n));
+
+        snprintf(name, sizeof(name), "%s sub_n %zu", kernels->name, n);
+        BENCH_PER_LIMB(name, n, sink += kernels->sub_n(res, a, b, n));
+
+        snprintf(name, sizeof(name), "%s addmul_1 %zu", kernels->name, n);
+        BENCH_PER_LIMB(name, n, sink += kernels->addmul_1(res, a, n, b[rep & 255]));
+
+        snprintf(name, sizeof(name), "%s submul_1 %zu", kernels->name, n);
+        BENCH_PER_LIMB(name, n, sink += kernels->submul_1(res, a, n, b[rep & 255]));
+    }
+}
+
+int main(void) {
+    printf("BN_WORD_SIZE = %d, selected = %s\n", BN_WORD_SIZE, bn_kernels.name);
+    srand(1);
+
+    bench_kernels(bn_kernels_portable());
+    if (bn_kernels_adx() != NULL) {
+        bench_kernels(bn_kernels_adx());
+    }
+
+    return 0;
+}
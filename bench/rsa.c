@@ -0,0 +1,195 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "keys.h"
+#include "montgomery.h"
+#include "rsa.h"
+
+int main(void) {
+    printf("BN_WORD_SIZE = %d\n", BN_WORD_SIZE);
+
+    for (size_t k = 0; k < TEST_KEYS_COUNT; ++k) {
+        static rsa_pub_key_t pub_key;
+        static rsa_pvt_key_t pvt_key;
+        static montg_t montg_domain_n, montg_domain_p, montg_domain_q;
+
+        import_pub_key(&pub_key, test_keys[k].pub_data);
+        import_pvt_key(&pvt_key, test_keys[k].pvt_data);
+        montg_init(&montg_domain_n, &pub_key.mod);
+        montg_init(&montg_domain_p, &pvt_key.p);
+        montg_init(&montg_domain_q, &pvt_key.q);
+        if (k == 0) {
+            printf("engine = %s\n", montg_domain_n.engine == MONTG_ENGINE_IFMA ? "ifma" : "scalar");
+        }
+
+        const size_t msg_len = test_keys[k].bits / 8 - 1;
+        char msg[BN_MSG_LEN + 1] = "";
+        for (size_t i = 0; i < msg_len; ++i) {
+            msg[i] = (char)(i * 7 + 1);
+        }
+        char out_enc[BN_BYTE_SIZE * 2 + 1] = "", out_dec[BN_MSG_LEN + 1] = "";
+        char name[64];
+
+        snprintf(name, sizeof(name), "montg_init n %zu", test_keys[k].bits);
+        BENCH_RUN(name, montg_init(&montg_domain_n, &pub_key.mod));
+
+        // Одно умножение и квадрат в домене n, операнды - константы домена
+        static bignum_t montg_res;
+        snprintf(name, sizeof(name), "montg_mul n %zu", test_keys[k].bits);
+        BENCH_RUN(name, montg_mul(&montg_domain_n, &montg_domain_n.r, &montg_domain_n.r2, &montg_res));
+
+        snprintf(name, sizeof(name), "montg_transform n %zu", test_keys[k].bits);
+        BENCH_RUN(name, montg_transform(&montg_domain_n, &montg_domain_n.r2, &montg_res));
+
+        snprintf(name, sizeof(name), "montg_sqr n %zu", test_keys[k].bits);
+        BENCH_RUN(name, montg_sqr(&montg_domain_n, &montg_domain_n.r2, &montg_res));
+
+        // Закрытый показатель по модулю n: двоичный метод против скользящего окна
+        snprintf(name, sizeof(name), "montg_pow_binary n %zu", test_keys[k].bits);
+        BENCH_RUN(name, montg_pow_binary(&montg_domain_n, &montg_domain_n.r2, &pvt_key.pvt_exp, &montg_res));
+
+        snprintf(name, sizeof(name), "montg_pow n %zu", test_keys[k].bits);
+        BENCH_RUN(name, montg_pow(&montg_domain_n, &montg_domain_n.r2, &pvt_key.pvt_exp, &montg_res));
+
+        // Загрузка ключа целиком: разбор и три домена (n, p, q)
+        snprintf(name, sizeof(name), "load key %zu", test_keys[k].bits);
+        BENCH_RUN(name, {
+            import_pub_key(&pub_key, test_keys[k].pub_data);
+            import_pvt_key(&pvt_key, test_keys[k].pvt_data);
+            montg_init(&montg_domain_n, &pub_key.mod);
+            montg_init(&montg_domain_p, &pvt_key.p);
+            montg_init(&montg_domain_q, &pvt_key.q);
+        });
+
+        encrypt_buf(&pub_key, &montg_domain_n, msg, msg_len, out_enc, sizeof(out_enc));
+        snprintf(name, sizeof(name), "encrypt_buf %zu", test_keys[k].bits);
+        BENCH_RUN(name, encrypt_buf(&pub_key, &montg_domain_n, msg, msg_len, out_enc, sizeof(out_enc)));
+
+        snprintf(name, sizeof(name), "decrypt_buf %zu", test_keys[k].bits);
+        BENCH_RUN(name, decrypt_buf(&pvt_key, &montg_domain_n, &montg_domain_p, &montg_domain_q, out_enc,
+                                    strlen(out_enc), out_dec, sizeof(out_dec)));
+        if (memcmp(msg, out_dec, msg_len) != 0) {
+            printf("decrypt_buf %zu: wrong result\n", test_keys[k].bits);
+            return 1;
+        }
+
+        // Двоичный вид: те же операции без перевода в шестнадцатеричную строку и обратно
+        static uint8_t msg_be[BN_MSG_LEN], bin_enc[BN_MSG_LEN], bin_dec[BN_MSG_LEN];
+        const size_t bin_len = rsa_bin_len(&montg_domain_n);
+        for (size_t i = 0; i < msg_len; ++i) {
+            msg_be[msg_len - 1 - i] = (uint8_t)msg[i];
+        }
+        snprintf(name, sizeof(name), "encrypt_bin %zu", test_keys[k].bits);
+        BENCH_RUN(name, encrypt_bin(&pub_key, &montg_domain_n, msg_be, msg_len, bin_enc, sizeof(bin_enc)));
+
+        snprintf(name, sizeof(name), "decrypt_bin %zu", test_keys[k].bits);
+        BENCH_RUN(name, decrypt_bin(&pvt_key, &montg_domain_n, &montg_domain_p, &montg_domain_q, bin_enc, bin_len,
+                                    bin_dec, sizeof(bin_dec)));
+        if (memcmp(msg_be, bin_dec + bin_len - msg_len, msg_len) != 0) {
+            printf("decrypt_bin %zu: wrong result\n", test_keys[k].bits);
+            return 1;
+        }
+
+        // Половины CRT в двух потоках: выигрыш есть, только если процессору доступно больше одного ядра
+        rsa_set_parallel_crt(1);
+        snprintf(name, sizeof(name), "decrypt_buf parallel crt %zu", test_keys[k].bits);
+        BENCH_RUN(name, decrypt_buf(&pvt_key, &montg_domain_n, &montg_domain_p, &montg_domain_q, out_enc,
+                                    strlen(out_enc), out_dec, sizeof(out_dec)));
+        rsa_set_parallel_crt(0);
+        if (memcmp(msg, out_dec, msg_len) != 0) {
+            printf("decrypt_buf parallel crt %zu: wrong result\n", test_keys[k].bits);
+            return 1;
+        }
+
+        snprintf(name, sizeof(name), "sign_buf %zu", test_keys[k].bits);
+        BENCH_RUN(name, sign_buf(&pvt_key, &montg_domain_n, msg, msg_len, out_enc, sizeof(out_enc)));
+
+        snprintf(name, sizeof(name), "verify_buf %zu", test_keys[k].bits);
+        BENCH_RUN(name, verify_buf(&pub_key, &montg_domain_n, out_enc, strlen(out_enc), out_dec, sizeof(out_dec)));
+
+        // Пакет подписей одного ключа для verify_buf по одной и verify_many ниже
+        enum { BATCH_SIZE = 64 };
+        static char batch_msgs[BATCH_SIZE][BN_MSG_LEN + 1], batch_sigs[BATCH_SIZE][BN_BYTE_SIZE * 2 + 1];
+        const char *batch_msg_ptrs[BATCH_SIZE], *batch_sig_ptrs[BATCH_SIZE];
+        for (size_t i = 0; i < BATCH_SIZE; ++i) {
+            for (size_t j = 0; j < msg_len; ++j) {
+                batch_msgs[i][j] = (char)(i * 31 + j * 7 + 1);
+            }
+            sign_buf(&pvt_key, &montg_domain_n, batch_msgs[i], msg_len, batch_sigs[i], sizeof(batch_sigs[i]));
+            batch_msg_ptrs[i] = batch_msgs[i];
+            batch_sig_ptrs[i] = batch_sigs[i];
+        }
+
+        snprintf(name, sizeof(name), "verify_buf x%d %zu", BATCH_SIZE, test_keys[k].bits);
+        BENCH_RUN_ITEMS(name, BATCH_SIZE, {
+            for (size_t i = 0; i < BATCH_SIZE; ++i) {
+                verify_buf(&pub_key, &montg_domain_n, batch_sigs[i], strlen(batch_sigs[i]), out_dec, sizeof(out_dec));
+            }
+        });
+
+        // Независимые буферы одного ключа: *_buf по одному против *_many (многобуферный движок)
+        static char batch_encs[BATCH_SIZE][BN_BYTE_SIZE * 2 + 1], batch_outs[BATCH_SIZE][BN_BYTE_SIZE * 2 + 1];
+        const char *batch_enc_ptrs[BATCH_SIZE];
+        char *batch_out_ptrs[BATCH_SIZE];
+        size_t batch_msg_lens[BATCH_SIZE], batch_enc_lens[BATCH_SIZE], batch_sig_lens[BATCH_SIZE];
+        for (size_t i = 0; i < BATCH_SIZE; ++i) {
+            encrypt_buf(&pub_key, &montg_domain_n, batch_msgs[i], msg_len, batch_encs[i], sizeof(batch_encs[i]));
+            batch_enc_ptrs[i] = batch_encs[i];
+            batch_out_ptrs[i] = batch_outs[i];
+            batch_msg_lens[i] = msg_len;
+            batch_enc_lens[i] = strlen(batch_encs[i]);
+            batch_sig_lens[i] = strlen(batch_sigs[i]);
+        }
+
+        snprintf(name, sizeof(name), "encrypt_buf x%d %zu", BATCH_SIZE, test_keys[k].bits);
+        BENCH_RUN_ITEMS(name, BATCH_SIZE, {
+            for (size_t i = 0; i < BATCH_SIZE; ++i) {
+                encrypt_buf(&pub_key, &montg_domain_n, batch_msgs[i], msg_len, batch_outs[i], sizeof(batch_outs[i]));
+            }
+        });
+
+        snprintf(name, sizeof(name), "encrypt_many x%d %zu", BATCH_SIZE, test_keys[k].bits);
+        BENCH_RUN_ITEMS(name, BATCH_SIZE,
+                        encrypt_many(&pub_key, &montg_domain_n, batch_msg_ptrs, batch_msg_lens, batch_out_ptrs,
+                                     sizeof(batch_outs[0]), BATCH_SIZE));
+
+        snprintf(name, sizeof(name), "decrypt_buf x%d %zu", BATCH_SIZE, test_keys[k].bits);
+        BENCH_RUN_ITEMS(name, BATCH_SIZE, {
+            for (size_t i = 0; i < BATCH_SIZE; ++i) {
+                decrypt_buf(&pvt_key, &montg_domain_n, &montg_domain_p, &montg_domain_q, batch_encs[i], batch_enc_lens[i],
+                            batch_outs[i], sizeof(batch_outs[i]));
+            }
+        });
+
+        snprintf(name, sizeof(name), "decrypt_many x%d %zu", BATCH_SIZE, test_keys[k].bits);
+        BENCH_RUN_ITEMS(name, BATCH_SIZE,
+                        decrypt_many(&pvt_key, &montg_domain_n, &montg_domain_p, &montg_domain_q, batch_enc_ptrs, batch_enc_lens,
+                                     batch_out_ptrs, sizeof(batch_outs[0]), BATCH_SIZE));
+        for (size_t i = 0; i < BATCH_SIZE; ++i) {
+            if (memcmp(batch_outs[i], batch_msgs[i], msg_len) != 0) {
+                printf("decrypt_many %zu: wrong result\n", test_keys[k].bits);
+                return 1;
+            }
+        }
+
+        snprintf(name, sizeof(name), "verify_many x%d %zu", BATCH_SIZE, test_keys[k].bits);
+        BENCH_RUN_ITEMS(name, BATCH_SIZE,
+                        verify_many(&pub_key, &montg_domain_n, batch_sig_ptrs, batch_sig_lens, batch_out_ptrs,
+                                    sizeof(batch_outs[0]), BATCH_SIZE));
+
+        // Пакетная проверка со сравнением сообщений: против verify_buf x64 выше
+        static uint8_t batch_results[BATCH_SIZE];
+        snprintf(name, sizeof(name), "verify_batch x%d %zu", BATCH_SIZE, test_keys[k].bits);
+        BENCH_RUN_ITEMS(name, BATCH_SIZE,
+                        verify_batch(&pub_key, &montg_domain_n, batch_sig_ptrs, batch_sig_lens, batch_msg_ptrs,
+                                     batch_msg_lens, batch_results, BATCH_SIZE));
+        if (verify_batch(&pub_key, &montg_domain_n, batch_sig_ptrs, batch_sig_lens, batch_msg_ptrs, batch_msg_lens,
+                         batch_results, BATCH_SIZE) != 0) {
+            printf("verify_batch %zu: wrong result\n", test_keys[k].bits);
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "keys.h"
+#include "montgomery.h"
+#include "rsa.h"
+#include "rsa_pool.h"
+
+#define POOL_JOBS 256
+
+// Пропускная способность пула от 1 до числа ядер: расшифрование и подпись, затем смешанный пакет
+int main(void) {
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    const size_t max_threads = MIN((size_t)(cpus > 0 ? cpus : 1), (size_t)RSA_POOL_MAX_THREADS);
+    printf("BN_WORD_SIZE = %d, cpus = %zu\n", BN_WORD_SIZE, max_threads);
+
+    for (size_t k = 0; k < TEST_KEYS_COUNT; ++k) {
+        static rsa_pub_key_t pub_key;
+        static rsa_pvt_key_t pvt_key;
+        static montg_t montg_domain_n, montg_domain_p, montg_domain_q;
+        static char msgs[POOL_JOBS][BN_MSG_LEN + 1], encs[POOL_JOBS][BN_BYTE_SIZE * 2 + 1], outs[POOL_JOBS][BN_BYTE_SIZE * 2 + 1];
+        static rsa_job_t decrypt_jobs[POOL_JOBS], sign_jobs[POOL_JOBS], mixed_jobs[POOL_JOBS];
+
+        import_pub_key(&pub_key, test_keys[k].pub_data);
+        import_pvt_key(&pvt_key, test_keys[k].pvt_data);
+        montg_init(&montg_domain_n, &pub_key.mod);
+        montg_init(&montg_domain_p, &pvt_key.p);
+        montg_init(&montg_domain_q, &pvt_key.q);
+        const rsa_keyset_t keys = {&pub_key, &pvt_key, &montg_domain_n, &montg_domain_p, &montg_domain_q};
+
+        const size_t msg_len = test_keys[k].bits / 8 - 1;
+        for (size_t i = 0; i < POOL_JOBS; ++i) {
+            for (size_t j = 0; j < msg_len; ++j) {
+                msgs[i][j] = (char)(i * 31 + j * 7 + 1);
+            }
+            encrypt_buf(&pub_key, &montg_domain_n, msgs[i], msg_len, encs[i], sizeof(encs[i]));
+
+            decrypt_jobs[i] = (rsa_job_t){RSA_JOB_DECRYPT, &keys, encs[i], strlen(encs[i]), outs[i], sizeof(outs[i])};
+            sign_jobs[i] = (rsa_job_t){RSA_JOB_SIGN, &keys, msgs[i], msg_len, outs[i], sizeof(outs[i])};
+            // Каждое восьмое задание - закрытый ключ, остальные - открытый: неравные задания проверяют кражу работы
+            mixed_jobs[i] = i % 8 == 0 ? decrypt_jobs[i] : (rsa_job_t){RSA_JOB_ENCRYPT, &keys, msgs[i], msg_len, outs[i], sizeof(outs[i])};
+        }
+
+        // 1, 2, 4, ... и max_threads
+        for (size_t threads = 1;; threads = MIN(threads * 2, max_threads)) {
+            static rsa_pool_t pool;
+            char name[64];
+            if (rsa_pool_init(&pool, threads) != 0) {
+                printf("rsa_pool_init %zu: failed\n", threads);
+                return 1;
+            }
+
+            snprintf(name, sizeof(name), "pool decrypt %zu, %zu threads", test_keys[k].bits, threads);
+            BENCH_RUN_ITEMS(name, POOL_JOBS, rsa_pool_run(&pool, decrypt_jobs, POOL_JOBS));
+            for (size_t i = 0; i < POOL_JOBS; ++i) {
+                if (memcmp(outs[i], msgs[i], msg_len) != 0) {
+                    printf("pool decrypt %zu: wrong result\n", test_keys[k].bits);
+                    return 1;
+                }
+            }
+
+            snprintf(name, sizeof(name), "pool sign %zu, %zu threads", test_keys[k].bits, threads);
+            BENCH_RUN_ITEMS(name, POOL_JOBS, rsa_pool_run(&pool, sign_jobs, POOL_JOBS));
+
+            snprintf(name, sizeof(name), "pool mixed %zu, %zu threads", test_keys[k].bits, threads);
+            BENCH_RUN_ITEMS(name, POOL_JOBS, rsa_pool_run(&pool, mixed_jobs, POOL_JOBS));
+            printf("%-40s %12zu\n", "steals", rsa_pool_steals(&pool));
+
+            rsa_pool_destroy(&pool);
+            if (threads == max_threads) {
+                break;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "keys.h"
+#include "montgomery.h"
+#include "rsa.h"
+#include "rsa_stream.h"
+
+#define STREAM_DATA_SIZE (4u << 20)
+#define STREAM_CHUNK (64u << 10)
+// Расшифрование 4 МБ ключом 4096 идёт десятки секунд, поэтому только до этой длины
+#define STREAM_DECRYPT_MAX_BITS 2048
+
+static char data[STREAM_DATA_SIZE];
+// Шифротекст чуть больше чем вдвое длиннее: две цифры на байт и на байт больше в блоке
+static char enc[STREAM_DATA_SIZE * 3];
+static char dec[STREAM_DATA_SIZE + (64u << 10)];
+
+// Прогоняет in через поток порциями по STREAM_CHUNK, как при чтении файла; возвращает длину выхода
+static size_t stream_run(rsa_stream_t *stream, const char *in, size_t in_len, char *out) {
+    size_t written = 0;
+    for (size_t pos = 0; pos < in_len; pos += STREAM_CHUNK) {
+        written += rsa_stream_update(stream, in + pos, MIN((size_t)STREAM_CHUNK, in_len - pos), out + written);
+    }
+
+    size_t tail = 0;
+    rsa_stream_final(stream, out + written, &tail);
+    return written + tail;
+}
+
+// Пропускная способность потокового зашифрования и расшифрования 4 МБ, синхронно и с потоком
+int main(void) {
+    printf("BN_WORD_SIZE = %d\n", BN_WORD_SIZE);
+    for (size_t i = 0; i < STREAM_DATA_SIZE; ++i) {
+        data[i] = (char)(i * 31 + 7);
+    }
+
+    for (size_t k = 0; k < TEST_KEYS_COUNT; ++k) {
+        static rsa_pub_key_t pub_key;
+        static rsa_pvt_key_t pvt_key;
+        static montg_t montg_domain_n, montg_domain_p, montg_domain_q;
+        static rsa_stream_t stream;
+
+        import_pub_key(&pub_key, test_keys[k].pub_data);
+        import_pvt_key(&pvt_key, test_keys[k].pvt_data);
+        montg_init(&montg_domain_n, &pub_key.mod);
+        montg_init(&montg_domain_p, &pvt_key.p);
+        montg_init(&montg_domain_q, &pvt_key.q);
+
+        for (int async = 0; async <= 1; ++async) {
+            char name[64];
+            size_t enc_len = 0, dec_len = 0;
+
+            snprintf(name, sizeof(name), "stream encrypt %zu%s", test_keys[k].bits, async ? ", async" : "");
+            BENCH_RUN_BYTES(name, STREAM_DATA_SIZE, {
+                rsa_stream_encrypt_init(&stream, &pub_key, &montg_domain_n, async);
+                enc_len = stream_run(&stream, data, STREAM_DATA_SIZE, enc);
+            });
+
+            if (test_keys[k].bits > STREAM_DECRYPT_MAX_BITS) {
+                continue;
+            }
+            snprintf(name, sizeof(name), "stream decrypt %zu%s", test_keys[k].bits, async ? ", async" : "");
+            BENCH_RUN_BYTES(name, STREAM_DATA_SIZE, {
+                rsa_stream_decrypt_init(&stream, &pvt_key, &montg_domain_n, &montg_domain_p, &montg_domain_q, async);
+                dec_len = stream_run(&stream, enc, enc_len, dec);
+            });
+            if (dec_len != STREAM_DATA_SIZE || memcmp(dec, data, STREAM_DATA_SIZE) != 0) {
+                printf("stream %zu: wrong result\n", test_keys[k].bits);
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,22 @@
+#ifndef BARRETT_H
+#define BARRETT_H
+
+#include "bignum.h"
+
+// Контекст приведения Барретта: mu = floor(B^2k / mod), k - число значащих разрядов mod.
+// В отличие от домена Монтгомери числа остаются в обычном виде, поэтому контекст
+// удобен для разовых приведений (CRT), где перевод в домен и обратно не окупается
+typedef struct {
+    bignum_t mod;
+    bignum_t mu;            // k + 1 разрядов
+    size_t k;
+} barrett_t;
+
+// mod > 0 не длиннее BN_ARRAY_SIZE / 2 разрядов, иначе k = 0 и barrett_reduce сводится к bn_mod
+void barrett_init(barrett_t *ctx, const bignum_t *mod);
+// res = val mod mod, определён на 2k разрядах; val читается на 2k разрядах (val < B^2k), res может совпадать с val
+void barrett_reduce(const barrett_t *ctx, const bignum_t *val, bignum_t *res);
+// res = lhs * rhs mod mod, lhs и rhs меньше mod. При k = 0 - bn_mod произведения, которое должно поместиться в bignum_t
+void barrett_mulmod(const barrett_t *ctx, const bignum_t *lhs, const bignum_t *rhs, bignum_t *res);
+
+#endif // BARRETT_H
@@ -3,30 +3,51 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <sys/uio.h>
 
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
 
-#define BN_WORD_SIZE 4 // bytes
+#ifndef BN_WORD_SIZE
+    #if defined(__SIZEOF_INT128__)
+        #define BN_WORD_SIZE 8 // bytes
+    #else
+        #define BN_WORD_SIZE 4 // bytes
+    #endif
+#endif
 
 #if (BN_WORD_SIZE == 2)
     #define BN_DTYPE uint16_t
     #define BN_DTYPE_TMP uint32_t
-    #define BN_SPRINTF_FORMAT_STR "%.04hx"
-    #define BN_SSCANF_FORMAT_STR "%4hx"
     #define BN_MAX_VAL ((BN_DTYPE_TMP)0xFFFF)
 #elif (BN_WORD_SIZE == 4)
     #define BN_DTYPE uint32_t
     #define BN_DTYPE_TMP uint64_t
-    #define BN_SPRINTF_FORMAT_STR "%.08x"
-    #define BN_SSCANF_FORMAT_STR "%8x"
     #define BN_MAX_VAL ((BN_DTYPE_TMP)0xFFFFFFFF)
+#elif (BN_WORD_SIZE == 8)
+    #define BN_DTYPE uint64_t
+    #define BN_DTYPE_TMP unsigned __int128
+    #define BN_MAX_VAL ((BN_DTYPE_TMP)0xFFFFFFFFFFFFFFFF)
 #endif
 
-#define KEY_SIZE (512) // bits
+// Максимальный поддерживаемый размер ключа, определяет ёмкость bignum_t.
+// Реальное число разрядов берётся из ключа (montg_t) во время выполнения.
+#ifndef KEY_SIZE
+    #define KEY_SIZE (4096) // bits
+#endif
 #define BN_MSG_LEN (KEY_SIZE / 8)
 #define BN_BYTE_SIZE (BN_MSG_LEN * 2)
 
 #define BN_ARRAY_SIZE (BN_BYTE_SIZE / BN_WORD_SIZE)
+// Число разрядов, начиная с которого bn_karatsuba переходит на умножение столбиком (Comba)
+#ifndef BN_KARATSUBA_CUTOFF
+    #define BN_KARATSUBA_CUTOFF 24
+#endif
+
+// Рабочая область для bn_karatsuba размера BN_ARRAY_SIZE (в разрядах), с запасом на округления
+#define BN_SCRATCH_MAX_SIZE (BN_ARRAY_SIZE * 2 + 64)
+
+#define BN_BITS_TO_WORDS(bits) (((bits) + BN_WORD_SIZE * 8 - 1) / (BN_WORD_SIZE * 8))
 
 typedef BN_DTYPE bignum_t[BN_ARRAY_SIZE];
 
@@ -39,20 +60,44 @@ typedef enum {
 void bn_init(bignum_t *n, const size_t size);
 void bn_assign(bignum_t *bignum_dst, const size_t bignum_dst_offset, const bignum_t *bignum_src,
                const size_t bignum_src_offset, const size_t count);
+// OS2IP: nbytes байт старшим байтом вперёд
 void bn_from_bytes(bignum_t *bignum, const uint8_t *bytes, const size_t nbytes);
+// То же для байтов, идущих подряд по iovcnt буферам
+void bn_from_iov(bignum_t *bignum, const struct iovec *iov, size_t iovcnt);
 void bn_from_string(bignum_t *bignum, const char *str, const size_t nbytes);
 void bn_from_int(bignum_t *bignum, const BN_DTYPE_TMP value, size_t size);
 
-void bn_to_string(const bignum_t *bignum, char *str, const size_t nbytes);
+// Пишет старшие разряды первыми, по BN_WORD_SIZE * 2 цифр на разряд, и возвращает длину строки.
+// Если строка вместе с '\0' не помещается в nbytes, пишется пустая строка
+size_t bn_to_string(const bignum_t *bignum, char *str, const size_t nbytes);
+// I2OSP: ровно nbytes байт старшим вперёд, с нулями слева. -1, если число не помещается (bytes тогда испорчен)
+int bn_to_bytes(const bignum_t *bignum, uint8_t *bytes, const size_t nbytes);
 
 void bn_add(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_res, size_t size);
 void bn_add_carry(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_res, size_t size);
 void bn_sub(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_res, size_t size);
+// Операции над значащими частями: size1/size2 - число значащих разрядов (bn_used_size),
+// возвращается длина результата; время пропорционально длинам, а не BN_ARRAY_SIZE.
+// bn_sub_used требует bignum1 >= bignum2, результат bn_mul_used не должен совпадать с операндами
+size_t bn_used_size(const bignum_t *bignum, size_t size);
+bignum_compare_state bn_cmp_used(const bignum_t *bignum1, const size_t size1, const bignum_t *bignum2, const size_t size2);
+size_t bn_add_used(const bignum_t *bignum1, const size_t size1, const bignum_t *bignum2, const size_t size2, bignum_t *bignum_res);
+size_t bn_sub_used(const bignum_t *bignum1, const size_t size1, const bignum_t *bignum2, const size_t size2, bignum_t *bignum_res);
+size_t bn_mul_used(const bignum_t *bignum1, const size_t size1, const bignum_t *bignum2, const size_t size2, bignum_t *bignum_res);
 void bn_karatsuba(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_res, size_t size);
+size_t bn_karatsuba_size(const size_t words);
+// Вариант с рабочей областью вызывающего; без неё используется область потока
+void bn_karatsuba_ws(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_res, size_t size, BN_DTYPE *scratch);
+size_t bn_karatsuba_scratch_size(const size_t size);
+// Байт C-стека, которые занимает стек кадров одного умножения
+size_t bn_karatsuba_stack_size(void);
 void bn_div(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_res, size_t size);
 void bn_mod(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_res, size_t size);
 void bn_divmod(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_div, bignum_t *bignum_mod, size_t size);
 
+// Сдвиг на произвольное число бит в пределах size разрядов, bignum_res может совпадать с bignum
+void bn_lshift(const bignum_t *bignum, bignum_t *bignum_res, const size_t bits, size_t size);
+void bn_rshift(const bignum_t *bignum, bignum_t *bignum_res, const size_t bits, size_t size);
 void bn_or(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_res, size_t size);
 size_t bn_bitcount(const bignum_t *bignum);
 
@@ -0,0 +1,41 @@
+#ifndef BIGNUM_KERNELS_H
+#define BIGNUM_KERNELS_H
+
+#include "bignum.h"
+#include <stddef.h>
+
+// Ядра над массивами разрядов длины n. Результат может совпадать с любым операндом,
+// возвращается перенос (заём) из старшего разряда
+typedef struct {
+    const char *name;
+    BN_DTYPE (*add_n)(BN_DTYPE *res, const BN_DTYPE *a, const BN_DTYPE *b, size_t n);
+    BN_DTYPE (*sub_n)(BN_DTYPE *res, const BN_DTYPE *a, const BN_DTYPE *b, size_t n);
+    // res += a * b, res -= a * b
+    BN_DTYPE (*addmul_1)(BN_DTYPE *res, const BN_DTYPE *a, size_t n, BN_DTYPE b);
+    BN_DTYPE (*submul_1)(BN_DTYPE *res, const BN_DTYPE *a, size_t n, BN_DTYPE b);
+} bn_kernels_t;
+
+// Выбираются при загрузке по возможностям процессора
+extern bn_kernels_t bn_kernels;
+
+const bn_kernels_t *bn_kernels_portable(void);
+// NULL, если процессор или сборка не поддерживают ADX/BMI2
+const bn_kernels_t *bn_kernels_adx(void);
+
+static inline BN_DTYPE bn_add_n(BN_DTYPE *res, const BN_DTYPE *a, const BN_DTYPE *b, size_t n) {
+    return bn_kernels.add_n(res, a, b, n);
+}
+
+static inline BN_DTYPE bn_sub_n(BN_DTYPE *res, const BN_DTYPE *a, const BN_DTYPE *b, size_t n) {
+    return bn_kernels.sub_n(res, a, b, n);
+}
+
+static inline BN_DTYPE bn_addmul_1(BN_DTYPE *res, const BN_DTYPE *a, size_t n, BN_DTYPE b) {
+    return bn_kernels.addmul_1(res, a, n, b);
+}
+
+static inline BN_DTYPE bn_submul_1(BN_DTYPE *res, const BN_DTYPE *a, size_t n, BN_DTYPE b) {
+    return bn_kernels.submul_1(res, a, n, b);
+}
+
+#endif // BIGNUM_KERNELS_H
@@ -12,23 +12,22 @@ typedef enum {
     STAGE4,
 } stage_t;
 
-#define z_size 2
-
+// Кадр не хранит промежуточных чисел: z0 лежит в рабочей области (scratch),
+// выделенной вызывающим, поэтому push/pop копируют только указатели
 typedef struct {
     bignum_t *left;
     bignum_t *right;
     size_t in_bn_size;
     size_t bn_size_shift;
 
-    uint8_t is_using_z;
-    bignum_t z[z_size];
-    bignum_t *z0_ptr;
-    bignum_t *z1_ptr;
+    BN_DTYPE *scratch;
+    uint8_t carry_left;
+    uint8_t carry_right;
 
     size_t stage;
 } frame_t;
 
-void frame_init(frame_t *frame, const bignum_t *left, const bignum_t *right, size_t in_bn_size);
+void frame_init(frame_t *frame, const bignum_t *left, const bignum_t *right, size_t in_bn_size, BN_DTYPE *scratch);
 void frame_assign(frame_t *frame_dst, const frame_t *frame_src);
 
-#endif //FRAME_H
\ No newline at end of file
+#endif //FRAME_H
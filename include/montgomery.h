@@ -3,18 +3,88 @@
 
 #include "bignum.h"
 
+// Реализация умножения в возведении в степень; результаты у всех одинаковые
+typedef enum {
+    MONTG_ENGINE_SCALAR,
+    MONTG_ENGINE_IFMA,              // AVX-512 IFMA, разряды по 52 бита
+} montg_engine_t;
+
+// Многобуферный движок (AVX2): MONTG_MB_LANES независимых чисел с общими модулем и показателем,
+// разряды по MONTG_MB_BITS бит чередуются по числам
+#define MONTG_MB_LANES 4
+#define MONTG_MB_BITS 27
+
+// Наибольшая длина модуля в битах, при которой проход MONTG_MB_LANES чисел быстрее, чем их
+// возведение в степень по одному движком домена: 27-битные разряды AVX2 проигрывают 64-битным
+// скалярным умножениям и IFMA на длинных модулях
+#ifndef MONTG_MB_CUTOFF_SCALAR
+    #define MONTG_MB_CUTOFF_SCALAR 1024
+#endif
+#ifndef MONTG_MB_CUTOFF_IFMA
+    #define MONTG_MB_CUTOFF_IFMA 512
+#endif
+
+// Числа движка рассчитаны только на модули, для которых он выбирается; для более длинных mb_digits = 0
+#define MONTG_MB_MAX_BITS (MONTG_MB_CUTOFF_SCALAR > MONTG_MB_CUTOFF_IFMA ? MONTG_MB_CUTOFF_SCALAR : MONTG_MB_CUTOFF_IFMA)
+#define MONTG_MB_MAX_DIGITS (((KEY_SIZE < MONTG_MB_MAX_BITS ? KEY_SIZE : MONTG_MB_MAX_BITS) + 2 + MONTG_MB_BITS - 1) / MONTG_MB_BITS)
+
 typedef struct montgomery_domain {
     bignum_t mod;
-    bignum_t r;
-    bignum_t r_inv;
-    BN_DTYPE_TMP shift;
+    bignum_t r;                     // R mod n
+    bignum_t r2;                    // R^2 mod n
+    BN_DTYPE n0;                    // -n^-1 mod 2^(BN_WORD_SIZE * 8)
+    BN_DTYPE_TMP shift;             // число разрядов домена, R = 2^(shift * BN_WORD_SIZE * 8)
     BN_DTYPE_TMP shift_byte_size;
+
+    montg_engine_t engine;
+    // Данные IFMA: числа хранятся по 52 бита в uint64_t, R' = 2^(52 * ifma_digits)
+    bignum_t ifma_mod;
+    bignum_t ifma_c_in;             // R'^2 / R mod n: перевод x * R -> x * R'
+    bignum_t ifma_c_out;            // R mod n: перевод x * R' -> x * R
+    bignum_t ifma_r2;               // R'^2 mod n: перевод x -> x * R'
+    uint64_t ifma_n0;               // -n^-1 mod 2^52
+    size_t ifma_digits;             // кратно 8, 0 - движок недоступен
+    // Данные многобуферного движка: R'' = 2^(MONTG_MB_BITS * mb_digits), константы по разряду
+    uint32_t mb_mod[MONTG_MB_MAX_DIGITS];
+    uint32_t mb_r2[MONTG_MB_MAX_DIGITS];    // R''^2 mod n: перевод x -> x * R''
+    uint32_t mb_n0;                         // -n^-1 mod 2^MONTG_MB_BITS
+    size_t mb_digits;                       // 0 - движок недоступен
+    uint8_t mb_use;                         // montg_pow_many идёт через движок; выбирается по длине модуля и engine
 } montg_t;
 
+// Если удвоенный домен mod не помещается в bignum_t (или mod нулевой), md обнуляется: shift = 0 означает
+// неинициализированный домен, montg_pow* и функции rsa.h с ним ничего не пишут в результат
 void montg_init(montg_t *md, const bignum_t *mod);
+// Возвращает -1, если движок не поддерживается процессором или сборкой
+int montg_set_engine(montg_t *md, montg_engine_t engine);
+// val < R (не больше shift значащих разрядов), результат меньше mod
 void montg_transform(const montg_t *md, const bignum_t *val, bignum_t *res);
 void montg_revert(const montg_t *md, const bignum_t *val, bignum_t *res);
+// Одно умножение в домене R; при любом engine скалярное, движок домена используют только montg_pow*
 void montg_mul(const montg_t *md, const bignum_t *lhs, const bignum_t *rhs, bignum_t *res);
+void montg_sqr(const montg_t *md, const bignum_t *val, bignum_t *res);
+// Скользящее окно, ширина выбирается по длине exp
 void montg_pow(const montg_t *md, const bignum_t *b, const bignum_t *exp, bignum_t *res);
+// Двоичный метод слева направо, эталон для montg_pow
+void montg_pow_binary(const montg_t *md, const bignum_t *b, const bignum_t *exp, bignum_t *res);
+// val^exp mod n для короткого показателя (открытая экспонента); val и res - обычные числа, не в домене,
+// val - любое число на shift * 2 разрядах (меньше R^2), приводится по n целиком:
+// перевод в домен - первое умножение, обратный перевод совмещён с последним умножением на val
+void montg_pow_small(const montg_t *md, const bignum_t *val, const uint32_t exp, bignum_t *res);
+// res[i] = vals[i]^exp mod n для count чисел в обычном виде (на shift * 2 разрядах, как у montg_pow_small) с общим показателем:
+// по MONTG_MB_LANES за проход многобуферного движка при md->mb_use, иначе montg_pow по одному
+void montg_pow_many(const montg_t *md, const bignum_t *vals, const bignum_t *exp, bignum_t *res, size_t count);
+
+// Умножение и квадрат движка над его числами; у IFMA и многобуферного движка числа хранятся по-своему,
+// и bignum_t * для них - только адрес
+typedef void (*montg_mul_t)(const montg_t *md, const bignum_t *lhs, const bignum_t *rhs, bignum_t *res);
+typedef void (*montg_sqr_t)(const montg_t *md, const bignum_t *val, bignum_t *res);
+
+#define MONTG_WINDOW_MAX 6
+
+// Цикл скользящего окна montg_pow для любого движка: числа движка по size байт, ширина окна не больше
+// width_max <= MONTG_WINDOW_MAX; table - место под 2^(width_max - 1) чисел, tmp - под одно
+void montg_pow_window_run(const montg_t *md, const bignum_t *b, const bignum_t *exp, bignum_t *res, size_t size,
+                          size_t width_max, bignum_t *table, bignum_t *tmp, montg_mul_t mul, montg_sqr_t sqr);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,22 @@
+#ifndef __MONTGOMERY_IFMA_H__
+#define __MONTGOMERY_IFMA_H__
+
+#include "montgomery.h"
+
+// Движок собирается только для x86-64 с 64-битными разрядами bignum,
+// наличие инструкций проверяется во время выполнения
+#if defined(__x86_64__) && defined(__GNUC__) && BN_WORD_SIZE == 8 && !defined(MONTG_NO_IFMA)
+    #define MONTG_IFMA_ENABLED
+#endif
+
+int montg_ifma_supported(void);
+// Заполняет поля ifma_* готового скалярного домена, ifma_digits = 0 при неудаче
+void montg_ifma_init(montg_t *md);
+
+// Смена основания: shift разрядов по 64 бита <-> ifma_digits разрядов по 52 бита
+void montg_ifma_from_bn(const montg_t *md, const bignum_t *val, bignum_t *res);
+void montg_ifma_to_bn(const montg_t *md, const bignum_t *val, bignum_t *res);
+// res = lhs * rhs / R' mod n, операнды и результат по 52 бита
+void montg_ifma_mul(const montg_t *md, const bignum_t *lhs, const bignum_t *rhs, bignum_t *res);
+
+#endif
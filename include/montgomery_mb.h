@@ -0,0 +1,18 @@
+#ifndef __MONTGOMERY_MB_H__
+#define __MONTGOMERY_MB_H__
+
+#include "montgomery.h"
+
+// Движок собирается только для x86-64, наличие AVX2 проверяется во время выполнения
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(MONTG_NO_MB)
+    #define MONTG_MB_ENABLED
+#endif
+
+int montg_mb_supported(void);
+// Заполняет поля mb_* готового скалярного домена, mb_digits = 0 без AVX2 или для модуля длиннее MONTG_MB_MAX_BITS
+void montg_mb_init(montg_t *md);
+
+// res[l] = vals[l]^exp mod n для MONTG_MB_LANES чисел в обычном виде, vals[l] < n, exp != 0
+void montg_mb_pow(const montg_t *md, const bignum_t *vals, const bignum_t *exp, bignum_t *res);
+
+#endif
@@ -1,13 +1,17 @@
 #ifndef RSA_H
 #define RSA_H
 
+#include "barrett.h"
 #include "bignum.h"
 #include "montgomery.h"
 #include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
 
 typedef struct {
     bignum_t mod;
     bignum_t pub_exp;
+    uint32_t pub_exp_small;     // pub_exp, если помещается в 32 бита (3, 17, 65537), иначе 0
 } rsa_pub_key_t;
 
 typedef struct {
@@ -19,15 +23,46 @@ typedef struct {
     bignum_t exp1;
     bignum_t exp2;
     bignum_t coeff;
+    barrett_t barrett_p;        // контексты приведения по p и q для CRT, заполняются при импорте
+    barrett_t barrett_q;
 } rsa_pvt_key_t;
 
 void import_pub_key(rsa_pub_key_t *key, const char *data);
 void import_pvt_key(rsa_pvt_key_t *key, const char *data);
 
 void encrypt_buf(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const char *buffer_in, size_t buffer_in_len, char *buffer_out, size_t buffer_out_len);
+// Вторая половина CRT в decrypt считается постоянным вспомогательным потоком, пока enable != 0.
+// Поток обслуживает один вызов за раз, остальные считают обе половины сами. -1, если поток не создан.
+// Сама функция не должна вызываться из нескольких потоков одновременно
+int rsa_set_parallel_crt(int enable);
 void decrypt_buf(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const montg_t *montg_domain_p, const montg_t *montg_domain_q, const char *buffer_in, size_t buffer_in_len, char *buffer_out, size_t buffer_out_len);
 
 void sign_buf(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const char *buffer_in, size_t buffer_in_len, char *buffer_out, size_t buffer_out_len);
 void verify_buf(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const char *buffer_in, size_t buffer_in_len, char *buffer_out, size_t buffer_out_len);
 
+// Двоичный вид без промежуточных строк: числа - строки октетов старшим байтом вперёд (OS2IP/I2OSP).
+// Вход не длиннее rsa_bin_len байт и меньше n, выход - ровно rsa_bin_len байт, out_len не меньше.
+// 0 или -1, если вход или выход не подходят
+size_t rsa_bin_len(const montg_t *montg_domain_n);
+int encrypt_bin(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len);
+int decrypt_bin(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const montg_t *montg_domain_p, const montg_t *montg_domain_q, const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len);
+int sign_bin(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len);
+int verify_bin(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len);
+
+// То же со входом, собранным из iovcnt буферов подряд
+int encrypt_iov(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const struct iovec *iov, size_t iovcnt, uint8_t *out, size_t out_len);
+int decrypt_iov(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const montg_t *montg_domain_p, const montg_t *montg_domain_q, const struct iovec *iov, size_t iovcnt, uint8_t *out, size_t out_len);
+int sign_iov(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const struct iovec *iov, size_t iovcnt, uint8_t *out, size_t out_len);
+int verify_iov(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const struct iovec *iov, size_t iovcnt, uint8_t *out, size_t out_len);
+
+// То же для count независимых буферов одного ключа: по MONTG_MB_LANES за проход многобуферного движка.
+// buffers_in_len[i] - длина buffers_in[i], все buffers_out[i] длины buffer_out_len
+void encrypt_many(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const char *const *buffers_in, const size_t *buffers_in_len, char *const *buffers_out, size_t buffer_out_len, size_t count);
+void decrypt_many(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const montg_t *montg_domain_p, const montg_t *montg_domain_q, const char *const *buffers_in, const size_t *buffers_in_len, char *const *buffers_out, size_t buffer_out_len, size_t count);
+void verify_many(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const char *const *buffers_in, const size_t *buffers_in_len, char *const *buffers_out, size_t buffer_out_len, size_t count);
+// Проверка count подписей одного ключа поверх verify_many: results[i] = 1, если sigs[i] (строка длины sigs_len[i])
+// меньше n и даёт сообщение msgs[i] длины msgs_len[i], иначе 0. Каждая подпись проверяется своим возведением в степень.
+// 0, если верны все; -1, если есть неверная или домен не инициализирован (тогда results не меняется)
+int verify_batch(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const char *const *sigs, const size_t *sigs_len, const char *const *msgs, const size_t *msgs_len, uint8_t *results, size_t count);
+
 #endif // RSA_H
\ No newline at end of file
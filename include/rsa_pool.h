@@ -0,0 +1,75 @@
+#ifndef RSA_POOL_H
+#define RSA_POOL_H
+
+#include "montgomery.h"
+#include "rsa.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef RSA_POOL_MAX_THREADS
+    #define RSA_POOL_MAX_THREADS 64
+#endif
+
+typedef enum {
+    RSA_JOB_ENCRYPT,
+    RSA_JOB_DECRYPT,
+    RSA_JOB_SIGN,
+    RSA_JOB_VERIFY,
+} rsa_job_op_t;
+
+// Ключи и домены, общие для заданий; потоки пула только читают их.
+// Для ENCRYPT/VERIFY нужен pub_key, для DECRYPT/SIGN - pvt_key, для DECRYPT ещё домены p и q
+typedef struct {
+    const rsa_pub_key_t *pub_key;
+    const rsa_pvt_key_t *pvt_key;
+    const montg_t *montg_domain_n;
+    const montg_t *montg_domain_p;
+    const montg_t *montg_domain_q;
+} rsa_keyset_t;
+
+// Одно задание - один вызов соответствующей *_buf с теми же буферами
+typedef struct {
+    rsa_job_op_t op;
+    const rsa_keyset_t *keys;
+    const char *buffer_in;
+    size_t buffer_in_len;
+    char *buffer_out;
+    size_t buffer_out_len;
+} rsa_job_t;
+
+struct rsa_pool;
+
+// Очередь потока - непрерывный диапазон номеров заданий [top, bottom): владелец берёт
+// задания с конца, а поток без работы забирает половину диапазона с начала
+typedef struct {
+    pthread_mutex_t lock;
+    size_t top;
+    size_t bottom;
+    size_t steals;              // сколько раз этот поток забирал чужую работу
+    pthread_t thread;
+    struct rsa_pool *pool;
+} rsa_pool_worker_t;
+
+typedef struct rsa_pool {
+    pthread_mutex_t lock;
+    pthread_cond_t start_cond;
+    pthread_cond_t done_cond;
+    rsa_pool_worker_t workers[RSA_POOL_MAX_THREADS];
+    size_t thread_count;
+    size_t generation;          // номер пакета, его рост будит потоки
+    size_t active;              // потоков, ещё не закончивших текущий пакет
+    uint8_t stop;
+    const rsa_job_t *jobs;
+} rsa_pool_t;
+
+// Запускает threads постоянных потоков (1 .. RSA_POOL_MAX_THREADS), -1 при ошибке
+int rsa_pool_init(rsa_pool_t *pool, size_t threads);
+void rsa_pool_destroy(rsa_pool_t *pool);
+// Раздаёт задания поровну по очередям потоков и ждёт, пока все не будут выполнены.
+// Вызовы из разных потоков выполняются по очереди
+void rsa_pool_run(rsa_pool_t *pool, const rsa_job_t *jobs, size_t count);
+// Сумма steals по потокам
+size_t rsa_pool_steals(rsa_pool_t *pool);
+
+#endif // RSA_POOL_H
@@ -0,0 +1,71 @@
+#ifndef RSA_STREAM_H
+#define RSA_STREAM_H
+
+#include "montgomery.h"
+#include "rsa.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Блоков в порции, которая шифруется одним вызовом encrypt_many/decrypt_many
+#ifndef RSA_STREAM_SLOT_BLOCKS
+    #define RSA_STREAM_SLOT_BLOCKS 16
+#endif
+
+// Наибольший блок: шестнадцатеричный шифротекст ключа KEY_SIZE вместе с '\0'
+#define RSA_STREAM_BLOCK_MAX (BN_MSG_LEN * 2 + 1)
+
+// Байт открытого текста в блоке - на один меньше длины модуля, так что блок всегда меньше n.
+// Последний блок дополняется байтом 0x80 и нулями (ISO/IEC 7816-4), при кратной длине - целым блоком.
+// Шифротекст - блоки шестнадцатеричных цифр одной длины (по числу разрядов модуля), без разделителей
+
+typedef struct {
+    char in[RSA_STREAM_SLOT_BLOCKS][RSA_STREAM_BLOCK_MAX];
+    char out[RSA_STREAM_SLOT_BLOCKS][RSA_STREAM_BLOCK_MAX];
+    size_t blocks;
+} rsa_stream_slot_t;
+
+typedef struct {
+    uint8_t decrypt;
+    const rsa_pub_key_t *pub_key;
+    const rsa_pvt_key_t *pvt_key;
+    const montg_t *montg_domain_n;
+    const montg_t *montg_domain_p;
+    const montg_t *montg_domain_q;
+    size_t in_block;            // байт входа на блок: открытый текст при шифровании, цифры при расшифровании
+    size_t out_block;
+
+    // Заполняется slots[filling], блок slots[filling].in[blocks] заполнен на fill байт
+    rsa_stream_slot_t slots[2];
+    size_t filling;
+    size_t fill;
+
+    // Расшифрованный блок придерживается до следующего: у последнего снимается дополнение
+    char held[RSA_STREAM_BLOCK_MAX];
+    uint8_t has_held;
+
+    // Асинхронный режим: заполненная порция обрабатывается постоянным потоком,
+    // пока вызывающий читает следующую; её результат выдаёт следующий update или final
+    uint8_t async;
+    uint8_t in_flight;
+    uint8_t stop;
+    rsa_stream_slot_t *job;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t job_cond;
+    pthread_cond_t done_cond;
+} rsa_stream_t;
+
+// async != 0 запускает поток шифрования, который завершается в rsa_stream_final; -1, если он не создан
+int rsa_stream_encrypt_init(rsa_stream_t *stream, const rsa_pub_key_t *key, const montg_t *montg_domain_n, int async);
+int rsa_stream_decrypt_init(rsa_stream_t *stream, const rsa_pvt_key_t *key, const montg_t *montg_domain_n,
+                            const montg_t *montg_domain_p, const montg_t *montg_domain_q, int async);
+
+// Сколько байт может записать update с in_len байт входа (final - с in_len = 0)
+size_t rsa_stream_out_size(const rsa_stream_t *stream, size_t in_len);
+// Возвращает число записанных в out байт; в асинхронном режиме выход отстаёт на порцию
+size_t rsa_stream_update(rsa_stream_t *stream, const char *in, size_t in_len, char *out);
+// Дописывает остаток в out, *out_len - его длина. -1, если шифротекст обрезан или дополнение неверно
+int rsa_stream_final(rsa_stream_t *stream, char *out, size_t *out_len);
+
+#endif // RSA_STREAM_H
@@ -4,7 +4,8 @@
 #include "frame.h"
 #include <stddef.h>
 
-#define STACK_SIZE 100
+// Глубина рекурсии Карацубы — log2(размер / BN_KARATSUBA_CUTOFF) + 1, кадры маленькие
+#define STACK_SIZE 64
 
 typedef frame_t element_t;
 
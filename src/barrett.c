@@ -0,0 +1,80 @@
+#include "barrett.h"
+#include "bignum.h"
+#include "bignum_kernels.h"
+
+#include <string.h>
+
+// B^2k может не поместиться в bignum_t, поэтому делится B^2k - 1: частное то же,
+// кроме mod - степени двойки, где оно меньше на единицу и даёт лишнее вычитание в barrett_reduce
+void barrett_init(barrett_t *ctx, const bignum_t *mod) {
+    const size_t k = bn_used_size(mod, BN_ARRAY_SIZE);
+    bignum_t pow;
+
+    bn_init(&ctx->mod, BN_ARRAY_SIZE);
+    bn_assign(&ctx->mod, 0, mod, 0, k);
+
+    // Произведение двух остатков должно поместиться в bignum_t
+    ctx->k = k * 2 <= BN_ARRAY_SIZE ? k : 0;
+    if (ctx->k == 0) {
+        return;
+    }
+
+    bn_init(&pow, BN_ARRAY_SIZE);
+    bn_memset(&pow, 0, 0xFF, k * 2);
+    bn_div(&pow, &ctx->mod, &ctx->mu, k * 2);
+}
+
+// q3 = floor(floor(val / B^(k-1)) * mu / B^(k+1)) отличается от частного не больше чем на 2,
+// поэтому остаток считается по модулю B^(k+1) и доводится вычитаниями mod
+void barrett_reduce(const barrett_t *ctx, const bignum_t *val, bignum_t *res) {
+    const size_t k = ctx->k;
+    if (k == 0) {
+        bn_mod(val, &ctx->mod, res, BN_ARRAY_SIZE);
+        return;
+    }
+
+    // q2 = q1 * mu: 2k + 2 разрядов, на разряд больше половины bignum_t при k = BN_ARRAY_SIZE / 2
+    const BN_DTYPE *q1 = *val + k - 1;
+    BN_DTYPE q2[BN_ARRAY_SIZE + 2];
+    memset(q2, 0, (k + 1) * BN_WORD_SIZE);
+    for (size_t i = 0; i <= k; ++i) {
+        q2[i + k + 1] = bn_addmul_1(q2 + i, q1, k + 1, ctx->mu[i]);
+    }
+    const BN_DTYPE *q3 = q2 + k + 1;
+
+    // r2 = q3 * mod mod B^(k+1): только младшие k + 1 разрядов произведения
+    BN_DTYPE r2[BN_ARRAY_SIZE / 2 + 1];
+    memset(r2, 0, (k + 1) * BN_WORD_SIZE);
+    for (size_t i = 0; i <= k; ++i) {
+        const size_t len = MIN(k, k + 1 - i);
+        const BN_DTYPE carry = bn_addmul_1(r2 + i, ctx->mod, len, q3[i]);
+        if (i + len <= k) {
+            r2[i + len] += carry;
+        }
+    }
+
+    // r = val - q3 * mod по модулю B^(k+1), 0 <= r < 3 * mod
+    BN_DTYPE r[BN_ARRAY_SIZE / 2 + 1];
+    bn_sub_n(r, *val, r2, k + 1);
+    while (r[k] != 0 || bn_cmp((const bignum_t *)r, &ctx->mod, k) != BN_CMP_SMALLER) {
+        r[k] -= bn_sub_n(r, r, ctx->mod, k);
+    }
+
+    bn_init(res, k * 2);
+    memcpy(*res, r, k * BN_WORD_SIZE);
+}
+
+void barrett_mulmod(const barrett_t *ctx, const bignum_t *lhs, const bignum_t *rhs, bignum_t *res) {
+    bignum_t prod;
+
+    // Без контекста (mod длиннее BN_ARRAY_SIZE / 2) - как в barrett_reduce: произведение и bn_mod
+    if (ctx->k == 0) {
+        bn_init(&prod, BN_ARRAY_SIZE);
+        bn_mul_used(lhs, bn_used_size(lhs, BN_ARRAY_SIZE), rhs, bn_used_size(rhs, BN_ARRAY_SIZE), &prod);
+        bn_mod(&prod, &ctx->mod, res, BN_ARRAY_SIZE);
+        return;
+    }
+
+    bn_karatsuba(lhs, rhs, &prod, ctx->k * 2);
+    barrett_reduce(ctx, &prod, res);
+}
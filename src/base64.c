@@ -30,8 +30,14 @@ int base64_read(const uint8_t *in, const size_t in_size, uint8_t *out, const siz
         out[w + 2] = (v64[in[r + 2]] << 6) | (v64[in[r + 3]] >> 0);
     }
 
-    if (w - 2 < out_size) {
-        out[w - 2] = '\0';
+    // Символы '=' в конце дополняют последнюю группу, реальных байтов в ней меньше
+    size_t padding = 0;
+    while (padding < 2 && padding < in_size && in[in_size - 1 - padding] == '=') {
+        ++padding;
+    }
+
+    if (w - padding < out_size) {
+        out[w - padding] = '\0';
     }
 
     return in_size * 4 / 3;
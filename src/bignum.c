@@ -1,16 +1,17 @@
 #include "bignum.h"
+#include "bignum_kernels.h"
 #include "frame.h"
 #include "stack.h"
 
 #include <stdint.h>
-#include <stdio.h>
 #include <string.h>
 #include <strings.h>
 
-static void lshift_one_bit(bignum_t *bignum);
-static void rshift_one_bit(bignum_t *bignum);
 
-static void bn_inner_karatsuba(bignum_t *left, const bignum_t *right, const size_t in_bn_size);
+static void bn_inner_karatsuba(bignum_t *left, const bignum_t *right, const size_t in_bn_size, BN_DTYPE *scratch);
+static void bn_comba(const BN_DTYPE *left, const BN_DTYPE *right, BN_DTYPE *res, const size_t in_bn_size);
+static BN_DTYPE lshift_bits(const BN_DTYPE *src, BN_DTYPE *dst, const size_t count, const size_t bits);
+static void rshift_bits(const BN_DTYPE *src, BN_DTYPE *dst, const size_t count, const size_t bits);
 
 // memset может выйти за границы bignum, никак не проверяется
 void bn_memset(bignum_t *bignum, const size_t offset, const int value, const size_t count) {
@@ -28,32 +29,131 @@ void bn_assign(bignum_t *bignum_dst, const size_t bignum_dst_offset, const bignu
     memcpy((*bignum_dst) + bignum_dst_offset, (*bignum_src) + bignum_src_offset, count * BN_WORD_SIZE);
 }
 
+// Разряд из BN_WORD_SIZE байт старшим байтом вперёд и обратно: одна загрузка и разворот байтов
+#if BN_WORD_SIZE == 2
+    #define BN_BSWAP __builtin_bswap16
+#elif BN_WORD_SIZE == 4
+    #define BN_BSWAP __builtin_bswap32
+#else
+    #define BN_BSWAP __builtin_bswap64
+#endif
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    #undef BN_BSWAP
+    #define BN_BSWAP(x) (x)
+#endif
+
+static inline BN_DTYPE bn_load_be(const uint8_t *bytes) {
+    BN_DTYPE limb;
+    memcpy(&limb, bytes, BN_WORD_SIZE);
+    return BN_BSWAP(limb);
+}
+
+static inline void bn_store_be(uint8_t *bytes, BN_DTYPE limb) {
+    limb = BN_BSWAP(limb);
+    memcpy(bytes, &limb, BN_WORD_SIZE);
+}
+
 void bn_from_bytes(bignum_t *bignum, const uint8_t *bytes, const size_t nbytes) {
+    const struct iovec iov = {(void *)bytes, nbytes};
+    bn_from_iov(bignum, &iov, 1);
+}
+
+void bn_from_iov(bignum_t *bignum, const struct iovec *iov, size_t iovcnt) {
+    size_t total = 0;
+    for (size_t i = 0; i < iovcnt; ++i) {
+        total += iov[i].iov_len;
+    }
+
     bn_init(bignum, BN_ARRAY_SIZE);
 
     // Хорошо бы было вернуть какой-нибудь код ошибки
-    if (nbytes > BN_BYTE_SIZE) {
+    if (total > BN_BYTE_SIZE) {
         return;
     }
 
-    uint8_t padding = ((nbytes - 1) / BN_WORD_SIZE + 1) * BN_WORD_SIZE - nbytes;
+    // Буферы обходятся с конца, pos - номер байта числа от младшего. Байты до границы разряда
+    // и хвост буфера - по одному, между ними - целыми разрядами
+    size_t pos = 0;
+    for (size_t i = iovcnt; i-- > 0;) {
+        const uint8_t *bytes = iov[i].iov_base;
+        size_t len = iov[i].iov_len;
 
-    for (size_t i = 0; i < nbytes; ++i) {
-        (*bignum)[(nbytes - 1 - i) / BN_WORD_SIZE] |= (BN_DTYPE)bytes[i] << ((BN_WORD_SIZE - 1 - i - padding) % BN_WORD_SIZE) * 8;
+        for (; len > 0 && pos % BN_WORD_SIZE != 0; ++pos) {
+            (*bignum)[pos / BN_WORD_SIZE] |= (BN_DTYPE)bytes[--len] << pos % BN_WORD_SIZE * 8;
+        }
+        for (; len >= BN_WORD_SIZE; len -= BN_WORD_SIZE, pos += BN_WORD_SIZE) {
+            (*bignum)[pos / BN_WORD_SIZE] = bn_load_be(bytes + len - BN_WORD_SIZE);
+        }
+        for (; len > 0; ++pos) {
+            (*bignum)[pos / BN_WORD_SIZE] |= (BN_DTYPE)bytes[--len] << pos % BN_WORD_SIZE * 8;
+        }
     }
 }
 
+int bn_to_bytes(const bignum_t *bignum, uint8_t *bytes, const size_t nbytes) {
+    const size_t used = bn_used_size(bignum, BN_ARRAY_SIZE);
+    size_t end = nbytes, j = 0;
+
+    for (; j < used && end >= BN_WORD_SIZE; ++j, end -= BN_WORD_SIZE) {
+        bn_store_be(bytes + end - BN_WORD_SIZE, (*bignum)[j]);
+    }
+
+    // Старший разряд, не поместившийся целиком: его значащие байты должны уместиться в оставшиеся end
+    if (j < used) {
+        if (j + 1 < used) {
+            return -1;
+        }
+        BN_DTYPE limb = (*bignum)[j];
+        for (; end > 0; limb >>= 8) {
+            bytes[--end] = (uint8_t)limb;
+        }
+        if (limb != 0) {
+            return -1;
+        }
+    }
+    memset(bytes, 0, end);
+
+    return 0;
+}
+
+// Значения шестнадцатеричных цифр, остальные символы считаются нулём
+static const uint8_t bn_hex_values[256] = {
+    ['0'] = 0, ['1'] = 1, ['2'] = 2, ['3'] = 3, ['4'] = 4, ['5'] = 5, ['6'] = 6, ['7'] = 7, ['8'] = 8, ['9'] = 9,
+    ['a'] = 10, ['b'] = 11, ['c'] = 12, ['d'] = 13, ['e'] = 14, ['f'] = 15,
+    ['A'] = 10, ['B'] = 11, ['C'] = 12, ['D'] = 13, ['E'] = 14, ['F'] = 15,
+};
+
+static const char bn_hex_digits[] = "0123456789abcdef";
+
+#define BN_HEX_DIGITS (BN_WORD_SIZE * 2)
+
 void bn_from_string(bignum_t *bignum, const char *str, const size_t nbytes) {
     bn_init(bignum, BN_ARRAY_SIZE);
 
-    size_t i = nbytes;
+    // Хорошо бы было вернуть какой-нибудь код ошибки
+    if (nbytes > BN_BYTE_SIZE * 2) {
+        return;
+    }
+
+    // Полные разряды с конца строки
+    const uint8_t *digits = (const uint8_t *)str + nbytes;
     size_t j = 0;
-    while (i > 0) {
-        BN_DTYPE tmp = 0;
-        i = i > sizeof(BN_DTYPE_TMP) ? i - sizeof(BN_DTYPE_TMP) : 0;
-        sscanf(&str[i], BN_SSCANF_FORMAT_STR, &tmp);
-        (*bignum)[j] = tmp;
-        ++j;
+    for (; (j + 1) * BN_HEX_DIGITS <= nbytes; ++j) {
+        digits -= BN_HEX_DIGITS;
+        BN_DTYPE limb = 0;
+        for (size_t k = 0; k < BN_HEX_DIGITS; ++k) {
+            limb = (limb << 4) | bn_hex_values[digits[k]];
+        }
+        (*bignum)[j] = limb;
+    }
+
+    // Неполный старший разряд
+    if (digits != (const uint8_t *)str) {
+        BN_DTYPE limb = 0;
+        for (const uint8_t *p = (const uint8_t *)str; p != digits; ++p) {
+            limb = (limb << 4) | bn_hex_values[*p];
+        }
+        (*bignum)[j] = limb;
     }
 }
 
@@ -67,37 +167,35 @@ void bn_from_int(bignum_t *bignum, const BN_DTYPE_TMP value, size_t size) {
     }
 }
 
-void bn_to_string(const bignum_t *bignum, char *str, size_t nbytes) {
-    int j = BN_ARRAY_SIZE - 1;
-    size_t i = 0;
-    while (j >= 0 && nbytes > i + 1) {
-        if ((*bignum)[j]) {
-            sprintf(&str[i], BN_SPRINTF_FORMAT_STR, (*bignum)[j]);
-            i += sizeof(BN_DTYPE_TMP);
+size_t bn_to_string(const bignum_t *bignum, char *str, size_t nbytes) {
+    const size_t used = bn_used_size(bignum, BN_ARRAY_SIZE);
+    const size_t len = used * BN_HEX_DIGITS;
+
+    if (nbytes == 0) {
+        return len;
+    }
+    if (len >= nbytes) {
+        str[0] = '\0';
+        return len;
+    }
+
+    for (size_t j = used; j-- > 0; str += BN_HEX_DIGITS) {
+        BN_DTYPE limb = (*bignum)[j];
+        for (size_t k = BN_HEX_DIGITS; k-- > 0; limb >>= 4) {
+            str[k] = bn_hex_digits[limb & 0xF];
         }
-        --j;
     }
+    *str = '\0';
 
-    str[i] = '\0';
+    return len;
 }
 
 void bn_add(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_res, size_t size) {
-    uint8_t carry = 0;
-    for (size_t i = 0; i < size; ++i) {
-        BN_DTYPE_TMP tmp = (BN_DTYPE_TMP)(*bignum1)[i] + (*bignum2)[i] + carry;
-        carry = tmp > BN_MAX_VAL;
-        (*bignum_res)[i] = tmp & BN_MAX_VAL;
-    }
+    bn_add_n(*bignum_res, *bignum1, *bignum2, size);
 }
 
 void bn_add_carry(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_res, size_t size) {
-    uint8_t carry = 0;
-    for (size_t i = 0; i + 1 < size; ++i) {
-        BN_DTYPE_TMP tmp = (BN_DTYPE_TMP)(*bignum1)[i] + (*bignum2)[i] + carry;
-        carry = tmp > BN_MAX_VAL;
-        (*bignum_res)[i] = tmp & BN_MAX_VAL;
-    }
-    (*bignum_res)[size - 1] = carry;
+    (*bignum_res)[size - 1] = bn_add_n(*bignum_res, *bignum1, *bignum2, size - 1);
 }
 
 void bn_sub(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_res, size_t size) {
@@ -105,116 +203,208 @@ void bn_sub(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_r
         return;
     }
 
-    uint8_t borrow = 0;
-    for (size_t i = 0; i < size; ++i) {
-        BN_DTYPE_TMP tmp1 = (BN_DTYPE_TMP)(*bignum1)[i] + BN_MAX_VAL + 1;
-        BN_DTYPE_TMP tmp2 = (BN_DTYPE_TMP)(*bignum2)[i] + borrow;
-        BN_DTYPE_TMP res = tmp1 - tmp2;
-        (*bignum_res)[i] = (BN_DTYPE)(res & BN_MAX_VAL);
-        borrow = res <= BN_MAX_VAL;
+    bn_sub_n(*bignum_res, *bignum1, *bignum2, size);
+}
+
+size_t bn_karatsuba_size(const size_t words) {
+    if (words <= BN_KARATSUBA_CUTOFF) {
+        return words;
     }
+
+    return bn_karatsuba_size((words + 1) >> 1) << 1;
+}
+
+// Рабочая область умножений по умолчанию, своя у каждого потока
+static _Thread_local BN_DTYPE bn_scratch[BN_SCRATCH_MAX_SIZE];
+
+// Кадр размера n берёт 2 * ceil(n / 2) + 1 разрядов под z0, остальное отдаёт дочерним кадрам;
+// на дне рекурсии нужно 2n разрядов под произведение столбиком
+static size_t bn_inner_karatsuba_scratch(const size_t in_bn_size) {
+    if (in_bn_size <= BN_KARATSUBA_CUTOFF) {
+        return in_bn_size << 1;
+    }
+
+    const size_t h = (in_bn_size + 1) >> 1;
+    return (h << 1) + 1 + bn_inner_karatsuba_scratch(h);
+}
+
+size_t bn_karatsuba_scratch_size(const size_t size) {
+    return bn_inner_karatsuba_scratch(size >> 1);
+}
+
+size_t bn_karatsuba_stack_size(void) {
+    return sizeof(stack_t);
 }
 
 void bn_karatsuba(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_res, size_t size) {
+    bn_karatsuba_ws(bignum1, bignum2, bignum_res, size, bn_scratch);
+}
+
+void bn_karatsuba_ws(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_res, size_t size, BN_DTYPE *scratch) {
+    if ((size >> 1) <= BN_KARATSUBA_CUTOFF) {
+        bn_comba(*bignum1, *bignum2, scratch, size >> 1);
+        memcpy(*bignum_res, scratch, size * BN_WORD_SIZE);
+        return;
+    }
+
     bn_assign(bignum_res, 0, bignum1, 0, size >> 1);
-    bn_inner_karatsuba(bignum_res, bignum2, size >> 1);
+    bn_inner_karatsuba(bignum_res, bignum2, size >> 1, scratch);
+}
+
+// res += b, перенос идёт не дальше res_count разрядов
+static void bn_words_add_to(BN_DTYPE *res, const size_t res_count, const BN_DTYPE *b, const size_t count) {
+    BN_DTYPE carry = bn_add_n(res, res, b, count);
+    for (size_t i = count; i < res_count && carry; ++i) {
+        carry = ++res[i] == 0;
+    }
+}
+
+// res -= b, результат должен быть неотрицательным
+static void bn_words_sub_from(BN_DTYPE *res, const size_t res_count, const BN_DTYPE *b, const size_t count) {
+    BN_DTYPE borrow = bn_sub_n(res, res, b, count);
+    for (size_t i = count; i < res_count && borrow; ++i) {
+        borrow = res[i]-- == 0;
+    }
 }
 
-static void bn_inner_karatsuba(bignum_t *left, const bignum_t *right, const size_t in_bn_size) {
+// res = a + b, где b короче a (count_b <= count_a), возвращает перенос
+static BN_DTYPE bn_words_add_uneven(BN_DTYPE *res, const BN_DTYPE *a, const size_t count_a, const BN_DTYPE *b, const size_t count_b) {
+    BN_DTYPE carry = bn_add_n(res, a, b, count_b);
+    for (size_t i = count_b; i < count_a; ++i) {
+        res[i] = a[i] + carry;
+        carry = res[i] < carry;
+    }
+
+    return carry;
+}
+
+// Прибавляет произведение к накопителю из трёх слов (c2:c1:c0)
+static inline void bn_mac(BN_DTYPE *c0, BN_DTYPE *c1, BN_DTYPE *c2, const BN_DTYPE_TMP prod) {
+    BN_DTYPE_TMP tmp = (BN_DTYPE_TMP)*c0 + (BN_DTYPE)prod;
+    *c0 = (BN_DTYPE)tmp;
+    tmp = (BN_DTYPE_TMP)*c1 + (BN_DTYPE)(prod >> (BN_WORD_SIZE * 8)) + (BN_DTYPE)(tmp >> (BN_WORD_SIZE * 8));
+    *c1 = (BN_DTYPE)tmp;
+    *c2 += (BN_DTYPE)(tmp >> (BN_WORD_SIZE * 8));
+}
+
+// Умножение "столбиком" по разрядам результата (Comba): для каждого разряда
+// все произведения складываются в накопитель из трёх слов, а перенос не гоняется по массиву
+static void bn_comba(const BN_DTYPE *left, const BN_DTYPE *right, BN_DTYPE *res, const size_t in_bn_size) {
+    BN_DTYPE c0 = 0, c1 = 0, c2 = 0;
+
+    for (size_t k = 0; k + 1 < in_bn_size << 1; ++k) {
+        const size_t beg = k < in_bn_size ? 0 : k - in_bn_size + 1;
+        const size_t end = k < in_bn_size ? k : in_bn_size - 1;
+
+        for (size_t i = beg; i <= end; ++i) {
+            bn_mac(&c0, &c1, &c2, (BN_DTYPE_TMP)left[i] * right[k - i]);
+        }
+
+        res[k] = c0;
+        c0 = c1;
+        c1 = c2;
+        c2 = 0;
+    }
+    res[(in_bn_size << 1) - 1] = c0;
+}
+
+// left = L2 * B^h + L1, right = R2 * B^h + R1, h = ceil(n / 2), произведение пишется на место left (2n разрядов).
+// Старшая половина left свободна до конца и служит под (R1 + R2), затем под L2 * R2;
+// в scratch кадр держит только z0 = (L1 + L2) * (R1 + R2). При нечётном n у L2 и R2 на разряд меньше
+static void bn_inner_karatsuba(bignum_t *left, const bignum_t *right, const size_t in_bn_size, BN_DTYPE *scratch) {
     stack_t stack;
     stack_init(&stack);
 
     frame_t frame_tmp;
-    frame_init(&frame_tmp, left, right, in_bn_size);
+    frame_init(&frame_tmp, left, right, in_bn_size, scratch);
     stack_push(&stack, &frame_tmp);
 
     while (!stack_is_empty(&stack)) {
         frame_t *frame;
         stack_peek(&stack, &frame);
 
+        BN_DTYPE *l = *frame->left;
+        const BN_DTYPE *r = *frame->right;
+        const size_t n = frame->in_bn_size;
+        const size_t h = (n + 1) >> 1, t = n - h;
+        BN_DTYPE *z0 = frame->scratch;
+        BN_DTYPE *child_scratch = frame->scratch + (h << 1) + 1;
+
         switch (frame->stage) {
             case STAGE1: {
-                if (frame->in_bn_size == 1) {
-                    bn_from_int(frame->left, (BN_DTYPE_TMP)(*frame->left)[0] * (BN_DTYPE_TMP)(*frame->right)[0], 2);
+                if (n <= BN_KARATSUBA_CUTOFF) {
+                    bn_comba(l, r, frame->scratch, n);
+                    memcpy(l, frame->scratch, (n << 1) * BN_WORD_SIZE);
                     stack_pop_without_get(&stack);
 
                     break;
                 }
-                
-                if (bn_is_zero(frame->left, frame->in_bn_size)) {
-                    bn_memset(frame->left, frame->in_bn_size, 0, frame->in_bn_size);
+
+                if (bn_is_zero(frame->left, n)) {
+                    bn_memset(frame->left, n, 0, n);
                     stack_pop_without_get(&stack);
-                    
+
                     break;
                 }
 
-                if (bn_is_zero(frame->right, frame->in_bn_size)) {
-                    bn_memset(frame->left, 0, 0, frame->in_bn_size << 1);
+                if (bn_is_zero(frame->right, n)) {
+                    bn_memset(frame->left, 0, 0, n << 1);
                     stack_pop_without_get(&stack);
-                    
+
                     break;
                 }
 
-                memset(frame->z, 0, z_size * (frame->in_bn_size << 1) * BN_WORD_SIZE);
-                frame->z0_ptr = (bignum_t *)((BN_DTYPE *) frame->z + 0);
-                frame->z1_ptr = (bignum_t *)((BN_DTYPE *) frame->z + (frame->in_bn_size << 1));
-                frame->is_using_z = 1;
-
-                frame->bn_size_shift = frame->in_bn_size >> 1;
-
-                // (L1 + L2)
-                bn_add_carry((bignum_t*)*frame->left, (bignum_t*)(*frame->left + frame->bn_size_shift), frame->z0_ptr, frame->bn_size_shift + 1);
+                frame->bn_size_shift = h;
 
-                // (R1 + R2)
-                bn_add_carry((bignum_t*)*frame->right, (bignum_t*)(*frame->right + frame->bn_size_shift), frame->z1_ptr, frame->bn_size_shift + 1);
+                // (L1 + L2) и (R1 + R2) без старшего бита, переносы учитываются в STAGE2
+                frame->carry_left = bn_words_add_uneven(z0, l, h, l + h, t);
+                frame->carry_right = bn_words_add_uneven(l + n, r, h, r + h, t);
+                z0[h << 1] = 0;
 
-                // (L1 + L2) * (R1 + R2)
-                const size_t size = ((*frame->z0_ptr)[frame->bn_size_shift] | (*frame->z1_ptr)[frame->bn_size_shift]) ? frame->in_bn_size : frame->bn_size_shift;
-
-                frame_t frame_tmp;
-                frame_init(&frame_tmp, frame->z0_ptr, frame->z1_ptr, size);
+                frame_init(&frame_tmp, (bignum_t *)z0, (bignum_t *)(l + n), h, child_scratch);
                 stack_push(&stack, &frame_tmp);
-                
+
                 frame->stage = STAGE2;
             }
             break;
 
             case STAGE2: {
-                // Z1 = L2 * R2
-                bn_assign(frame->z1_ptr, 0, frame->left, frame->bn_size_shift, frame->bn_size_shift);
+                // (a + ca * B^h) * (b + cb * B^h) = a * b + B^h * (ca * b + cb * (L1 + L2))
+                if (frame->carry_left) {
+                    bn_words_add_to(z0 + h, h + 1, l + n, h);
+                }
+                if (frame->carry_right) {
+                    bn_words_add_to(z0 + h, h + 1, l, h);
+                    bn_words_add_to(z0 + h, h + 1, l + h, t);
+                }
+
+                // left[2h..2n) = L2 * R2
+                memcpy(l + (h << 1), l + h, t * BN_WORD_SIZE);
 
-                frame_t frame_tmp;
-                frame_init(&frame_tmp, frame->z1_ptr, (bignum_t*)(*(bignum_t *)frame->right + frame->bn_size_shift), frame->bn_size_shift);
+                frame_init(&frame_tmp, (bignum_t *)(l + (h << 1)), (bignum_t *)(r + h), t, child_scratch);
                 stack_push(&stack, &frame_tmp);
-                
+
                 frame->stage = STAGE3;
             }
             break;
 
             case STAGE3: {
-                bn_sub(frame->z0_ptr, frame->z1_ptr, frame->z0_ptr, frame->in_bn_size << 1);
-
-                // left = L1 * R1
-                bn_memset(frame->left, frame->bn_size_shift, 0, frame->in_bn_size + frame->bn_size_shift);
+                bn_words_sub_from(z0, (h << 1) + 1, l + (h << 1), t << 1);
 
-                frame_t frame_tmp;
-                frame_init(&frame_tmp, frame->left, frame->right, frame->bn_size_shift);
+                // left[0..2h) = L1 * R1
+                frame_init(&frame_tmp, frame->left, frame->right, h, child_scratch);
                 stack_push(&stack, &frame_tmp);
-                
+
                 frame->stage = STAGE4;
             }
             break;
 
             case STAGE4: {
-                bn_sub(frame->z0_ptr, frame->left, frame->z0_ptr, frame->in_bn_size << 1);
+                bn_words_sub_from(z0, (h << 1) + 1, l, h << 1);
 
-                // Result Z2 + Z1 + Z0 (shift adjusted)
-                bn_assign(frame->left, frame->in_bn_size, frame->z1_ptr, 0, frame->in_bn_size);
-                bn_memset(frame->z1_ptr, 0, 0, frame->bn_size_shift);
-                bn_assign(frame->z1_ptr, frame->bn_size_shift, frame->z0_ptr, 0, frame->in_bn_size + 1);
-
-                bignum_t *bignum_answer = stack_get_size(&stack) != 1 ? frame->left : left;
-                bn_add(frame->left, frame->z1_ptr, bignum_answer, frame->in_bn_size << 1);
+                // L1 * R1 + (L1 * R2 + L2 * R1) * B^h + L2 * R2 * B^2h; старшие разряды z0 за пределами 2n нулевые
+                const size_t count = (n << 1) - h;
+                bn_words_add_to(l + h, count, z0, MIN((h << 1) + 1, count));
                 stack_pop_without_get(&stack);
             }
             break;
@@ -222,63 +412,199 @@ static void bn_inner_karatsuba(bignum_t *left, const bignum_t *right, const size
     }
 }
 
-void bn_div(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_res, size_t size) {
-    if (bn_is_zero(bignum2, size)) {
-        return;
+size_t bn_used_size(const bignum_t *bignum, size_t size) {
+    while (size > 0 && (*bignum)[size - 1] == 0) {
+        --size;
     }
 
-    bignum_t current;
-    bignum_t denom;
-    bignum_t tmp;
+    return size;
+}
 
-    bn_from_int(&current, 1, size);
-    bn_assign(&denom, 0, bignum2, 0, size);
-    bn_assign(&tmp, 0, bignum1, 0, size);
+bignum_compare_state bn_cmp_used(const bignum_t *bignum1, const size_t size1, const bignum_t *bignum2, const size_t size2) {
+    if (size1 != size2) {
+        return size1 < size2 ? BN_CMP_SMALLER : BN_CMP_LARGER;
+    }
 
-    uint8_t overflow = 0;
-    while (bn_cmp(&denom, bignum1, size) != BN_CMP_LARGER) {
-        const BN_DTYPE_TMP half_max = 1 + (BN_DTYPE_TMP)(BN_MAX_VAL / 2);
-        if (denom[size - 1] >= half_max) {
-            overflow = 1;
-            break;
-        }
-        lshift_one_bit(&current);
-        lshift_one_bit(&denom);
+    return size1 == 0 ? BN_CMP_EQUAL : bn_cmp(bignum1, bignum2, size1);
+}
+
+size_t bn_add_used(const bignum_t *bignum1, const size_t size1, const bignum_t *bignum2, const size_t size2, bignum_t *bignum_res) {
+    if (size1 < size2) {
+        return bn_add_used(bignum2, size2, bignum1, size1, bignum_res);
     }
-    if (!overflow) {
-        rshift_one_bit(&denom);
-        rshift_one_bit(&current);
+
+    BN_DTYPE carry = bn_add_n(*bignum_res, *bignum1, *bignum2, size2);
+    for (size_t i = size2; i < size1; ++i) {
+        const BN_DTYPE x = (*bignum1)[i] + carry;
+        carry = x < carry;
+        (*bignum_res)[i] = x;
     }
-    bn_init(bignum_res, size);
 
-    while (!bn_is_zero(&current, size)) {
-        if (bn_cmp(&tmp, &denom, size) != BN_CMP_SMALLER) {
-            bn_sub(&tmp, &denom, &tmp, size);
-            bn_or(bignum_res, &current, bignum_res, size);
-        }
-        rshift_one_bit(&current);
-        rshift_one_bit(&denom);
+    if (carry != 0) {
+        (*bignum_res)[size1] = carry;
+        return size1 + 1;
     }
+
+    return size1;
 }
 
-void bn_mod(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_res, size_t size) {
-    if (bn_is_zero(bignum2, size)) {
+size_t bn_sub_used(const bignum_t *bignum1, const size_t size1, const bignum_t *bignum2, const size_t size2, bignum_t *bignum_res) {
+    BN_DTYPE borrow = bn_sub_n(*bignum_res, *bignum1, *bignum2, size2);
+    for (size_t i = size2; i < size1; ++i) {
+        const BN_DTYPE x = (*bignum1)[i];
+        (*bignum_res)[i] = x - borrow;
+        borrow = borrow && x == 0;
+    }
+
+    return bn_used_size(bignum_res, size1);
+}
+
+// Умножение строками: O(size1 * size2), выгодно при коротком множителе (частные в алгоритме Евклида)
+size_t bn_mul_used(const bignum_t *bignum1, const size_t size1, const bignum_t *bignum2, const size_t size2, bignum_t *bignum_res) {
+    if (size1 == 0 || size2 == 0) {
+        return 0;
+    }
+
+    bn_memset(bignum_res, 0, 0, size1);
+    for (size_t j = 0; j < size2; ++j) {
+        (*bignum_res)[size1 + j] = bn_addmul_1(*bignum_res + j, *bignum1, size1, (*bignum2)[j]);
+    }
+
+    return bn_used_size(bignum_res, size1 + size2);
+}
+
+// Сдвиг count разрядов src влево на bits < BN_WORD_SIZE * 8 бит, возвращает вытесненные биты
+static BN_DTYPE lshift_bits(const BN_DTYPE *src, BN_DTYPE *dst, const size_t count, const size_t bits) {
+    if (bits == 0) {
+        memmove(dst, src, count * BN_WORD_SIZE);
+        return 0;
+    }
+
+    const BN_DTYPE out = src[count - 1] >> (BN_WORD_SIZE * 8 - bits);
+    for (size_t i = count - 1; i > 0; --i) {
+        dst[i] = (src[i] << bits) | (src[i - 1] >> (BN_WORD_SIZE * 8 - bits));
+    }
+    dst[0] = src[0] << bits;
+
+    return out;
+}
+
+// Сдвиг count разрядов src вправо на bits < BN_WORD_SIZE * 8 бит
+static void rshift_bits(const BN_DTYPE *src, BN_DTYPE *dst, const size_t count, const size_t bits) {
+    if (bits == 0) {
+        memmove(dst, src, count * BN_WORD_SIZE);
         return;
     }
 
-    bignum_t tmp;
-    bn_divmod(bignum1, bignum2, &tmp, bignum_res, size);
+    for (size_t i = 0; i + 1 < count; ++i) {
+        dst[i] = (src[i] >> bits) | (src[i + 1] << (BN_WORD_SIZE * 8 - bits));
+    }
+    dst[count - 1] = src[count - 1] >> bits;
 }
 
-void bn_divmod(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_div, bignum_t *bignum_mod, size_t size) {
-    if (bn_is_zero(bignum2, size)) {
+// Сдвиг на целые разряды сводится к смещению указателя, остаток битов - один проход lshift_bits
+void bn_lshift(const bignum_t *bignum, bignum_t *bignum_res, const size_t bits, size_t size) {
+    const size_t limbs = bits / (BN_WORD_SIZE * 8);
+    if (limbs >= size) {
+        bn_init(bignum_res, size);
+        return;
+    }
+
+    lshift_bits(*bignum, *bignum_res + limbs, size - limbs, bits % (BN_WORD_SIZE * 8));
+    bn_memset(bignum_res, 0, 0, limbs);
+}
+
+void bn_rshift(const bignum_t *bignum, bignum_t *bignum_res, const size_t bits, size_t size) {
+    const size_t limbs = bits / (BN_WORD_SIZE * 8);
+    if (limbs >= size) {
+        bn_init(bignum_res, size);
         return;
     }
 
-    bignum_t tmp;
-    bn_div(bignum1, bignum2, bignum_div, size);
-    bn_karatsuba(bignum_div, bignum2, &tmp, size);
-    bn_sub(bignum1, &tmp, bignum_mod, size);
+    rshift_bits(*bignum + limbs, *bignum_res, size - limbs, bits % (BN_WORD_SIZE * 8));
+    bn_memset(bignum_res, size - limbs, 0, limbs);
+}
+
+// Деление столбиком по разрядам (Knuth, TAOCP vol. 2, 4.3.1, Algorithm D).
+// bignum_div и bignum_mod могут быть NULL.
+static void bn_divmod_knuth(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_div, bignum_t *bignum_mod, size_t size) {
+    const size_t n = bn_used_size(bignum2, size);
+    const size_t m = bn_used_size(bignum1, size);
+
+    if (n == 0) {
+        return;
+    }
+
+    if (m < n) {
+        if (bignum_mod != NULL) {
+            bn_assign(bignum_mod, 0, bignum1, 0, size);
+        }
+        if (bignum_div != NULL) {
+            bn_init(bignum_div, size);
+        }
+        return;
+    }
+
+    // Нормализация: старший бит делителя должен быть установлен
+    size_t norm = 0;
+    for (BN_DTYPE top = (*bignum2)[n - 1]; !(top >> (BN_WORD_SIZE * 8 - 1)); top <<= 1) {
+        ++norm;
+    }
+
+    BN_DTYPE un[BN_ARRAY_SIZE + 1];
+    bignum_t vn, q;
+    lshift_bits(*bignum2, vn, n, norm);
+    un[m] = lshift_bits(*bignum1, un, m, norm);
+
+    for (size_t j = m - n + 1; j-- > 0;) {
+        // Оценка очередной цифры частного по двум старшим разрядам
+        const BN_DTYPE_TMP num = ((BN_DTYPE_TMP)un[j + n] << (BN_WORD_SIZE * 8)) | un[j + n - 1];
+        BN_DTYPE_TMP qhat = num / vn[n - 1];
+        BN_DTYPE_TMP rhat = num % vn[n - 1];
+
+        while (qhat > BN_MAX_VAL || (n > 1 && qhat * vn[n - 2] > ((rhat << (BN_WORD_SIZE * 8)) | un[j + n - 2]))) {
+            --qhat;
+            rhat += vn[n - 1];
+            if (rhat > BN_MAX_VAL) {
+                break;
+            }
+        }
+
+        // un[j..j+n] -= qhat * vn
+        const BN_DTYPE carry = bn_submul_1(un + j, vn, n, (BN_DTYPE)qhat);
+        const BN_DTYPE x = un[j + n];
+        un[j + n] = x - carry;
+
+        // Оценка оказалась на единицу больше - возвращаем делитель
+        if (x < carry) {
+            --qhat;
+            un[j + n] += bn_add_n(un + j, un + j, vn, n);
+        }
+
+        q[j] = (BN_DTYPE)qhat;
+    }
+
+    if (bignum_div != NULL) {
+        bn_init(bignum_div, size);
+        bn_assign(bignum_div, 0, &q, 0, m - n + 1);
+    }
+
+    if (bignum_mod != NULL) {
+        bn_init(bignum_mod, size);
+        rshift_bits(un, *bignum_mod, n, norm);
+    }
+}
+
+void bn_div(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_res, size_t size) {
+    bn_divmod_knuth(bignum1, bignum2, bignum_res, NULL, size);
+}
+
+void bn_mod(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_res, size_t size) {
+    bn_divmod_knuth(bignum1, bignum2, NULL, bignum_res, size);
+}
+
+void bn_divmod(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_div, bignum_t *bignum_mod, size_t size) {
+    bn_divmod_knuth(bignum1, bignum2, bignum_div, bignum_mod, size);
 }
 
 void bn_or(const bignum_t *bignum1, const bignum_t *bignum2, bignum_t *bignum_res, size_t size) {
@@ -310,20 +636,6 @@ uint8_t bn_is_zero(const bignum_t *bignum, size_t size) {
     return 1;
 }
 
-static void lshift_one_bit(bignum_t *bignum) {
-    for (size_t i = BN_ARRAY_SIZE - 1; i > 0; --i) {
-        (*bignum)[i] = ((*bignum)[i] << 1) | ((*bignum)[i - 1] >> (BN_WORD_SIZE * 8 - 1));
-    }
-    (*bignum)[0] <<= 1;
-}
-
-static void rshift_one_bit(bignum_t *bignum) {
-    for (size_t i = 0; i < BN_ARRAY_SIZE - 1; ++i) {
-        (*bignum)[i] = ((*bignum)[i] >> 1) | ((*bignum)[i + 1] << (BN_WORD_SIZE * 8 - 1));
-    }
-    (*bignum)[BN_ARRAY_SIZE - 1] >>= 1;
-}
-
 size_t bn_bitcount(const bignum_t *bignum) {
     size_t bits = (BN_BYTE_SIZE << 3) - (BN_WORD_SIZE << 3);
     int i;
@@ -331,6 +643,10 @@ size_t bn_bitcount(const bignum_t *bignum) {
         bits -= BN_WORD_SIZE << 3;
     }
 
+    if (i < 0) {
+        return 0;
+    }
+
     for (BN_DTYPE value = (*bignum)[i]; value != 0; value >>= 1) {
         bits++;
     }
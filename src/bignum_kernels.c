@@ -0,0 +1,194 @@
+#include "bignum_kernels.h"
+#include "bignum.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Переносы через сравнение результата с операндом, без широкого типа
+static BN_DTYPE add_n_portable(BN_DTYPE *res, const BN_DTYPE *a, const BN_DTYPE *b, size_t n) {
+    BN_DTYPE carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const BN_DTYPE s = a[i] + carry;
+        carry = s < carry;
+        const BN_DTYPE t = s + b[i];
+        carry += t < s;
+        res[i] = t;
+    }
+
+    return carry;
+}
+
+static BN_DTYPE sub_n_portable(BN_DTYPE *res, const BN_DTYPE *a, const BN_DTYPE *b, size_t n) {
+    BN_DTYPE borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const BN_DTYPE x = a[i], y = b[i];
+        const BN_DTYPE t = x - y;
+        res[i] = t - borrow;
+        borrow = (x < y) | (t < borrow);
+    }
+
+    return borrow;
+}
+
+static BN_DTYPE addmul_1_portable(BN_DTYPE *res, const BN_DTYPE *a, size_t n, BN_DTYPE b) {
+    BN_DTYPE_TMP carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        carry += (BN_DTYPE_TMP)a[i] * b + res[i];
+        res[i] = (BN_DTYPE)carry;
+        carry >>= BN_WORD_SIZE * 8;
+    }
+
+    return (BN_DTYPE)carry;
+}
+
+static BN_DTYPE submul_1_portable(BN_DTYPE *res, const BN_DTYPE *a, size_t n, BN_DTYPE b) {
+    BN_DTYPE carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const BN_DTYPE_TMP prod = (BN_DTYPE_TMP)a[i] * b + carry;
+        const BN_DTYPE low = (BN_DTYPE)prod, x = res[i];
+        carry = (BN_DTYPE)(prod >> (BN_WORD_SIZE * 8)) + (x < low);
+        res[i] = x - low;
+    }
+
+    return carry;
+}
+
+static const bn_kernels_t bn_kernels_portable_table = {
+    "portable", add_n_portable, sub_n_portable, addmul_1_portable, submul_1_portable,
+};
+
+bn_kernels_t bn_kernels = {
+    "portable", add_n_portable, sub_n_portable, addmul_1_portable, submul_1_portable,
+};
+
+const bn_kernels_t *bn_kernels_portable(void) {
+    return &bn_kernels_portable_table;
+}
+
+#if defined(__x86_64__) && defined(__GNUC__) && BN_WORD_SIZE == 8
+
+#include <immintrin.h>
+
+#define ADX_TARGET __attribute__((target("adx,bmi2")))
+
+typedef unsigned long long u64;
+
+ADX_TARGET static BN_DTYPE add_n_adx(BN_DTYPE *res, const BN_DTYPE *a, const BN_DTYPE *b, size_t n) {
+    unsigned char c = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        c = _addcarry_u64(c, a[i], b[i], (u64 *)&res[i]);
+        c = _addcarry_u64(c, a[i + 1], b[i + 1], (u64 *)&res[i + 1]);
+        c = _addcarry_u64(c, a[i + 2], b[i + 2], (u64 *)&res[i + 2]);
+        c = _addcarry_u64(c, a[i + 3], b[i + 3], (u64 *)&res[i + 3]);
+    }
+    for (; i < n; ++i) {
+        c = _addcarry_u64(c, a[i], b[i], (u64 *)&res[i]);
+    }
+
+    return c;
+}
+
+ADX_TARGET static BN_DTYPE sub_n_adx(BN_DTYPE *res, const BN_DTYPE *a, const BN_DTYPE *b, size_t n) {
+    unsigned char c = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        c = _subborrow_u64(c, a[i], b[i], (u64 *)&res[i]);
+        c = _subborrow_u64(c, a[i + 1], b[i + 1], (u64 *)&res[i + 1]);
+        c = _subborrow_u64(c, a[i + 2], b[i + 2], (u64 *)&res[i + 2]);
+        c = _subborrow_u64(c, a[i + 3], b[i + 3], (u64 *)&res[i + 3]);
+    }
+    for (; i < n; ++i) {
+        c = _subborrow_u64(c, a[i], b[i], (u64 *)&res[i]);
+    }
+
+    return c;
+}
+
+// Две независимые цепочки переносов: старшая половина предыдущего произведения
+// прибавляется к младшей текущего (c1), результат - к res (c2)
+// Цепочки переносов adcx (CF) и adox (OF) идут параллельно, поэтому цикл написан целиком
+// на ассемблере: компилятор не умеет держать два флага между итерациями.
+// Счётчик в rcx проверяется jrcxz, чтобы не трогать флаги
+#define ADDMUL_STEP(offset, hi_in, hi_out)            \
+    "mulx " offset "(%[a]), %[lo], %[" hi_out "]\n\t" \
+    "adcx %[" hi_in "], %[lo]\n\t"                    \
+    "adox " offset "(%[res]), %[lo]\n\t"              \
+    "mov %[lo], " offset "(%[res])\n\t"
+
+ADX_TARGET static BN_DTYPE addmul_1_adx(BN_DTYPE *res, const BN_DTYPE *a, size_t n, BN_DTYPE b) {
+    u64 carry = 0, lo, hi;
+    size_t blocks = n / 4;
+
+    __asm__(
+        "xor %[lo], %[lo]\n\t"
+        "1:\n\t"
+        "jrcxz 2f\n\t"
+        ADDMUL_STEP("0", "carry", "hi")
+        ADDMUL_STEP("8", "hi", "carry")
+        ADDMUL_STEP("16", "carry", "hi")
+        ADDMUL_STEP("24", "hi", "carry")
+        "lea 32(%[a]), %[a]\n\t"
+        "lea 32(%[res]), %[res]\n\t"
+        "lea -1(%[blocks]), %[blocks]\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        "mov $0, %[lo]\n\t"
+        "adcx %[lo], %[carry]\n\t"
+        "adox %[lo], %[carry]\n\t"
+        : [a] "+r"(a), [res] "+r"(res), [blocks] "+c"(blocks), [carry] "+r"(carry), [lo] "=&r"(lo), [hi] "=&r"(hi)
+        : "d"(b)
+        : "cc", "memory");
+
+    unsigned char c = 0;
+    for (size_t i = 0; i < n % 4; ++i) {
+        lo = _mulx_u64(a[i], b, &hi);
+        c = _addcarry_u64(0, lo, carry, &lo);
+        hi += c;
+        c = _addcarry_u64(0, res[i], lo, (u64 *)&res[i]);
+        carry = hi + c;
+    }
+
+    return carry;
+}
+
+ADX_TARGET static BN_DTYPE submul_1_adx(BN_DTYPE *res, const BN_DTYPE *a, size_t n, BN_DTYPE b) {
+    unsigned char c1 = 0, c2 = 0;
+    u64 hi, lo, carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        lo = _mulx_u64(a[i], b, &hi);
+        c1 = _addcarry_u64(c1, lo, carry, &lo);
+        c2 = _subborrow_u64(c2, res[i], lo, (u64 *)&res[i]);
+        carry = hi;
+    }
+
+    return carry + c1 + c2;
+}
+
+static const bn_kernels_t bn_kernels_adx_table = {
+    "adx", add_n_adx, sub_n_adx, addmul_1_adx, submul_1_adx,
+};
+
+const bn_kernels_t *bn_kernels_adx(void) {
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("adx") || !__builtin_cpu_supports("bmi2")) {
+        return NULL;
+    }
+
+    return &bn_kernels_adx_table;
+}
+
+#else
+
+const bn_kernels_t *bn_kernels_adx(void) {
+    return NULL;
+}
+
+#endif
+
+__attribute__((constructor)) static void bn_kernels_select(void) {
+    const bn_kernels_t *adx = bn_kernels_adx();
+    if (adx != NULL) {
+        bn_kernels = *adx;
+    }
+}
@@ -1,106 +1,214 @@
 #include "montgomery.h"
 #include "bignum.h"
+#include "bignum_kernels.h"
+#include "montgomery_ifma.h"
+#include "montgomery_mb.h"
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
 
-// Extended Euclidian algorithm
-static void montg_inverse(const bignum_t *val, const bignum_t *mod, bignum_t *res) {
-    if (bn_cmp(val, mod, BN_ARRAY_SIZE) != BN_CMP_SMALLER) {
-        return;
+static void montg_mul_scalar(const montg_t *md, const bignum_t *lhs, const bignum_t *rhs, bignum_t *res);
+static void montg_sqr_scalar(const montg_t *md, const bignum_t *val, bignum_t *res);
+
+// -n^-1 mod 2^w итерациями Ньютона: для нечётного n начальное приближение верно в 3 битах,
+// каждая итерация удваивает их число
+static BN_DTYPE montg_n0(const BN_DTYPE mod0) {
+    BN_DTYPE inv = mod0;
+    for (size_t i = 0; i < 5; ++i) {
+        inv = (BN_DTYPE)(inv * (BN_DTYPE)(2 - (BN_DTYPE)(mod0 * inv)));
     }
 
-    bignum_t n, b, q = {0}, r = {0}, t1 = {0}, t3 = {0};
-    bignum_t *n_ptr = &n, *b_ptr = &b;
-    bn_assign(&n, 0, mod, 0, BN_ARRAY_SIZE);
-    bn_assign(&b, 0, val, 0, BN_ARRAY_SIZE);
-    bn_from_int(res, 1, BN_ARRAY_SIZE);
+    return (BN_DTYPE)(0 - inv);
+}
+
+// val = 2 * val mod n, val < n
+static void montg_double(const montg_t *md, bignum_t *val) {
+    const size_t size = md->shift + 1;
+    bn_lshift(val, val, 1, size);
+    if (bn_cmp(val, &md->mod, size) != BN_CMP_SMALLER) {
+        bn_sub(val, &md->mod, val, size);
+    }
+}
 
-    bn_divmod(&n, &b, &q, &r, BN_ARRAY_SIZE);
-    bn_karatsuba(res, &q, &t3, BN_ARRAY_SIZE);
+// R mod n удвоениями от старшего бита n; R^2 mod n = (2^e * R) в квадрате k раз, e * 2^k = log2(R):
+// вместо деления 2 * shift-разрядного числа - e удвоений и k монтгомеровских квадратов
+static void montg_init_r(montg_t *md) {
+    const size_t r_bits = md->shift * BN_WORD_SIZE * 8;
+    const size_t top = bn_bitcount(&md->mod) - 1;
 
-    uint8_t sign = 1;
-    // Оптимизации ниже добавил только потому, что montg_inverse - static функция, вызываемая с известными параметрами
-    while (!bn_is_zero(&r, BN_ARRAY_SIZE)) {
-        bn_assign(&n, 0, &b, 0, BN_ARRAY_SIZE / 2 + 1);
-        bn_assign(&b, 0, &r, 0, BN_ARRAY_SIZE / 2);
-        bn_assign(&t1, 0, res, 0, BN_ARRAY_SIZE / 2);
-        bn_assign(res, 0, &t3, 0, BN_ARRAY_SIZE / 2);
+    bn_init(&md->r, BN_ARRAY_SIZE);
+    md->r[top / (BN_WORD_SIZE * 8)] = (BN_DTYPE)1 << (top % (BN_WORD_SIZE * 8));
+    for (size_t i = top; i < r_bits; ++i) {
+        montg_double(md, &md->r);
+    }
 
-        bn_divmod(n_ptr, b_ptr, &q, &r, BN_ARRAY_SIZE);
-        bn_karatsuba(res, &q, &t3, BN_ARRAY_SIZE);
-        bn_add(&t3, &t1, &t3, BN_ARRAY_SIZE / 2 + 1);
-        sign = !sign;
+    size_t e = r_bits, k = 0;
+    while (e % 2 == 0 && e > BN_WORD_SIZE * 8) {
+        e >>= 1;
+        ++k;
     }
 
-    if (!sign) {
-        bn_sub(mod, res, res, BN_ARRAY_SIZE / 2 + 1);
+    bn_assign(&md->r2, 0, &md->r, 0, BN_ARRAY_SIZE);
+    for (size_t i = 0; i < e; ++i) {
+        montg_double(md, &md->r2);
     }
+    for (size_t i = 0; i < k; ++i) {
+        montg_sqr_scalar(md, &md->r2, &md->r2);
+    }
+}
 
-    // Если b != 1 в конце, то res не существует. Данная функция не учитывает этот случай.
+// Karatsuba делит операнды пополам до BN_KARATSUBA_CUTOFF разрядов
+static size_t montg_domain_size(const bignum_t *mod) {
+    return bn_karatsuba_size(BN_BITS_TO_WORDS(bn_bitcount(mod)));
 }
 
 // mod - RSA key mod
 void montg_init(montg_t *md, const bignum_t *mod) {
-    if (mod == NULL) {
+    const size_t size = mod == NULL ? 0 : montg_domain_size(mod);
+    // Удвоенный размер домена должен поместиться в bignum_t; иначе домен остаётся пустым (shift = 0)
+    if (size == 0 || size * 2 > BN_ARRAY_SIZE) {
+        memset(md, 0, sizeof(*md));
         return;
     }
 
-    md->shift = BN_ARRAY_SIZE / 2;    // 512 для ключа 512 бит - лучше передавать ключ вместо mod для инициализации
-    md->shift_byte_size = BN_BYTE_SIZE / 2;
+    md->shift = size;
+    md->shift_byte_size = size * BN_WORD_SIZE;
 
-    bn_assign(&md->mod, 0, mod, 0, BN_ARRAY_SIZE);
+    bn_init(&md->mod, BN_ARRAY_SIZE);
+    bn_assign(&md->mod, 0, mod, 0, size);
 
-    bn_init(&md->r, BN_ARRAY_SIZE);
-    md->r[BN_ARRAY_SIZE / 2] = 1;
+    md->n0 = montg_n0(md->mod[0]);
+
+    // Константы считаются скалярным движком
+    md->engine = MONTG_ENGINE_SCALAR;
+    md->mb_use = 0;
+    montg_init_r(md);
+    montg_ifma_init(md);
+    montg_mb_init(md);
+    if (montg_set_engine(md, MONTG_ENGINE_IFMA) != 0) {
+        montg_set_engine(md, MONTG_ENGINE_SCALAR);
+    }
+}
+
+int montg_set_engine(montg_t *md, montg_engine_t engine) {
+    if (engine == MONTG_ENGINE_IFMA && (md->ifma_digits == 0 || !montg_ifma_supported())) {
+        return -1;
+    }
 
-    bn_sub(&md->r, &md->mod, &md->r_inv, BN_ARRAY_SIZE);
-    montg_inverse(&md->r_inv, &md->r, &md->r_inv);
+    md->engine = engine;
+    md->mb_use = md->mb_digits != 0 &&
+                 bn_bitcount(&md->mod) <= (engine == MONTG_ENGINE_IFMA ? MONTG_MB_CUTOFF_IFMA : MONTG_MB_CUTOFF_SCALAR);
+    return 0;
 }
 
+// val * R = val * R^2 / R: одно умножение CIOS, которое верно для любого val < R
 void montg_transform(const montg_t *md, const bignum_t *val, bignum_t *res) {
-    bignum_t temp;
-    memmove(temp + md->shift, *val, md->shift_byte_size);
-    memset(temp, 0, md->shift_byte_size);
-    bn_mod(&temp, &md->mod, res, BN_ARRAY_SIZE);
+    montg_mul_scalar(md, val, &md->r2, res);
 }
 
 void montg_revert(const montg_t *md, const bignum_t *val, bignum_t *res) {
     bignum_t one;
-    bn_from_int(&one, 1, BN_ARRAY_SIZE);
+    bn_from_int(&one, 1, md->shift * 2);
     montg_mul(md, val, &one, res);
 }
 
-void montg_mul(const montg_t *md, const bignum_t *lhs, const bignum_t *rhs, bignum_t *res) {
-    bignum_t m, m_r_inv, t;
-    uint8_t overflow = 0;
-    bn_karatsuba(lhs, rhs, &t, BN_ARRAY_SIZE);
-    bn_assign(res, 0, &t, 0, BN_ARRAY_SIZE);
-    bn_assign(&m, 0, res, 0, BN_ARRAY_SIZE);
+// REDC по разрядам: res = t * R^-1 mod m, t - произведение из md->shift * 2 разрядов.
+// На шаге i прибавляется m_i * mod * B^i, m_i = t_i * n0, что обнуляет разряд i
+static void montg_reduce(const montg_t *md, const bignum_t *t, bignum_t *res) {
+    const size_t size = md->shift;
+    bignum_t acc;
+    BN_DTYPE top = 0;   // перенос в разряд i + size + 1 с предыдущего шага
+    bn_assign(&acc, 0, t, 0, size * 2);
 
-    memset(m + md->shift, 0, md->shift_byte_size);
-    bn_karatsuba(&m, &md->r_inv, &m_r_inv, BN_ARRAY_SIZE);
-    memset(m_r_inv + md->shift, 0, md->shift_byte_size);
+    for (size_t i = 0; i < size; ++i) {
+        const BN_DTYPE m = (BN_DTYPE)(acc[i] * md->n0);
+        const BN_DTYPE carry = bn_addmul_1(acc + i, md->mod, size, m);
+        const BN_DTYPE_TMP sum = (BN_DTYPE_TMP)acc[i + size] + carry + top;
+        acc[i + size] = (BN_DTYPE)sum;
+        top = (BN_DTYPE)(sum >> (BN_WORD_SIZE * 8));
+    }
 
-    bn_karatsuba(&m_r_inv, &md->mod, &m, BN_ARRAY_SIZE);
-    bn_add(res, &m, res, BN_ARRAY_SIZE);
+    // Результат (top * R + acc / R) < 2 * mod
+    bn_assign(res, 0, &acc, size, size);
+    bn_memset(res, size, 0, size);
+    if (top || bn_cmp(res, &md->mod, size) != BN_CMP_SMALLER) {
+        bn_sub_n(*res, *res, md->mod, size);
+    }
+}
 
-    overflow = bn_cmp(res, &t, BN_ARRAY_SIZE) == BN_CMP_SMALLER && bn_cmp(res, &m, BN_ARRAY_SIZE) == BN_CMP_SMALLER;
+// CIOS: на шаге i к накопителю прибавляются lhs * rhs_i и m_i * mod, m_i = acc_i * n0,
+// после чего разряд i нулевой и окно накопителя сдвигается на разряд без копирования.
+// Оба прохода - bn_addmul_1, переносы сходятся в разряде i + size
+static void montg_mul_scalar(const montg_t *md, const bignum_t *lhs, const bignum_t *rhs, bignum_t *res) {
+    const size_t size = md->shift;
+    BN_DTYPE acc[BN_ARRAY_SIZE + 2];
+    memset(acc, 0, (size + 2) * BN_WORD_SIZE);
 
-    memmove(*res, *res + md->shift, md->shift_byte_size);
-    memset(*res + md->shift, 0, md->shift_byte_size);
+    for (size_t i = 0; i < size; ++i) {
+        const BN_DTYPE carry_mul = bn_addmul_1(acc + i, *lhs, size, (*rhs)[i]);
+        const BN_DTYPE m = (BN_DTYPE)(acc[i] * md->n0);
+        const BN_DTYPE carry_red = bn_addmul_1(acc + i, md->mod, size, m);
 
-    if (overflow) {
-        (*res)[BN_ARRAY_SIZE / 2] = 1;
+        const BN_DTYPE_TMP sum = (BN_DTYPE_TMP)acc[i + size] + carry_mul + carry_red;
+        acc[i + size] = (BN_DTYPE)sum;
+        acc[i + size + 1] = (BN_DTYPE)(sum >> (BN_WORD_SIZE * 8));
     }
 
-    if (bn_cmp(res, &md->mod, BN_ARRAY_SIZE) != BN_CMP_SMALLER) {
-        bn_sub(res, &md->mod, res, BN_ARRAY_SIZE);
+    // acc / R < 2 * mod: старший разряд не больше 1
+    bn_assign(res, 0, (const bignum_t *)(acc + size), 0, size);
+    bn_memset(res, size, 0, size);
+    if (acc[size * 2] || bn_cmp(res, &md->mod, size) != BN_CMP_SMALLER) {
+        bn_sub_n(*res, *res, md->mod, size);
     }
 }
 
-void montg_pow(const montg_t *md, const bignum_t *b, const bignum_t *exp, bignum_t *res) {
-    bn_assign(res, 0, b, 0, BN_ARRAY_SIZE);
+// Квадрат строками: перекрёстные произведения val_i * val_j, i < j, по строке bn_addmul_1 на i,
+// удвоение сдвигом, затем диагональ val_i^2; после этого REDC по разрядам
+static void montg_sqr_scalar(const montg_t *md, const bignum_t *val, bignum_t *res) {
+    const size_t size = md->shift;
+    bignum_t t;
+    bn_init(&t, size * 2);
+
+    for (size_t i = 0; i + 1 < size; ++i) {
+        t[i + size] = bn_addmul_1(t + (i << 1) + 1, *val + i + 1, size - i - 1, (*val)[i]);
+    }
+    bn_lshift(&t, &t, 1, size * 2);
+
+    BN_DTYPE carry = 0;
+    for (size_t i = 0; i < size; ++i) {
+        const BN_DTYPE_TMP prod = (BN_DTYPE_TMP)(*val)[i] * (*val)[i];
+        BN_DTYPE_TMP sum = (BN_DTYPE_TMP)t[i << 1] + (BN_DTYPE)prod + carry;
+        t[i << 1] = (BN_DTYPE)sum;
+        sum = (BN_DTYPE_TMP)t[(i << 1) + 1] + (BN_DTYPE)(prod >> (BN_WORD_SIZE * 8)) + (BN_DTYPE)(sum >> (BN_WORD_SIZE * 8));
+        t[(i << 1) + 1] = (BN_DTYPE)sum;
+        carry = (BN_DTYPE)(sum >> (BN_WORD_SIZE * 8));
+    }
+
+    montg_reduce(md, &t, res);
+}
+
+static void montg_sqr_ifma(const montg_t *md, const bignum_t *val, bignum_t *res) {
+    montg_ifma_mul(md, val, val, res);
+}
+
+// Одиночное умножение всегда идёт через CIOS: IFMA потребовал бы двух смен основания и второго
+// умножения на c_in, что дороже скалярного умножения. Движок домена работает внутри montg_pow*
+void montg_mul(const montg_t *md, const bignum_t *lhs, const bignum_t *rhs, bignum_t *res) {
+    montg_mul_scalar(md, lhs, rhs, res);
+}
+
+void montg_sqr(const montg_t *md, const bignum_t *val, bignum_t *res) {
+    montg_sqr_scalar(md, val, res);
+}
+
+typedef void (*montg_pow_loop_t)(const montg_t *md, const bignum_t *b, const bignum_t *exp, bignum_t *res, const size_t count,
+                                 const montg_mul_t mul, const montg_sqr_t sqr);
+
+// Слева направо по битам exp; mul/sqr и count (число разрядов числа) задают движок
+static void montg_pow_binary_loop(const montg_t *md, const bignum_t *b, const bignum_t *exp, bignum_t *res, const size_t count,
+                                  const montg_mul_t mul, const montg_sqr_t sqr)
+{
+    bn_assign(res, 0, b, 0, count);
     
     size_t len = bn_bitcount(exp) - 1;
     uint8_t *end = (uint8_t *)(*exp) + len / 8;
@@ -112,9 +220,9 @@ void montg_pow(const montg_t *md, const bignum_t *b, const bignum_t *exp, bignum
     }
 
     while (end >= beg) {
-        montg_mul(md, res, res, res);
+        sqr(md, res, res);
         if (*end & mask) {
-            montg_mul(md, b, res, res);
+            mul(md, b, res, res);
         }
 
         mask >>= 1;
@@ -124,3 +232,222 @@ void montg_pow(const montg_t *md, const bignum_t *b, const bignum_t *exp, bignum
         }
     }
 }
+
+static size_t montg_window_bits(const size_t bits) {
+    if (bits > 671) {
+        return 6;
+    }
+    if (bits > 239) {
+        return 5;
+    }
+    if (bits > 79) {
+        return 4;
+    }
+    if (bits > 23) {
+        return 3;
+    }
+
+    return 1;
+}
+
+static BN_DTYPE montg_exp_bit(const bignum_t *exp, const size_t i) {
+    return ((*exp)[i / (BN_WORD_SIZE * 8)] >> (i % (BN_WORD_SIZE * 8))) & 1;
+}
+
+// Скользящее окно: таблица нечётных степеней b, b^3, ..., b^(2^w - 1); окно начинается и
+// заканчивается единичным битом, нули между окнами - только возведения в квадрат
+void montg_pow_window_run(const montg_t *md, const bignum_t *b, const bignum_t *exp, bignum_t *res, const size_t size,
+                          const size_t width_max, bignum_t *table, bignum_t *tmp, const montg_mul_t mul, const montg_sqr_t sqr)
+{
+#define MONTG_TABLE(i) ((bignum_t *)((uint8_t *)table + (i) * size))
+    const size_t bits = bn_bitcount(exp);
+    const size_t width = MIN(montg_window_bits(bits), width_max);
+
+    memcpy(MONTG_TABLE(0), b, size);
+    if (width > 1) {
+        sqr(md, b, tmp);
+        for (size_t i = 1; i < (size_t)1 << (width - 1); ++i) {
+            mul(md, MONTG_TABLE(i - 1), tmp, MONTG_TABLE(i));
+        }
+    }
+
+    uint8_t started = 0;
+    for (size_t pos = bits; pos > 0;) {
+        const size_t top = pos - 1;
+        if (!montg_exp_bit(exp, top)) {
+            sqr(md, res, res);
+            pos = top;
+            continue;
+        }
+
+        size_t low = top + 1 >= width ? top + 1 - width : 0;
+        while (!montg_exp_bit(exp, low)) {
+            ++low;
+        }
+
+        size_t value = 0;
+        for (size_t i = top + 1; i-- > low;) {
+            value = (value << 1) | montg_exp_bit(exp, i);
+        }
+
+        if (started) {
+            for (size_t i = low; i <= top; ++i) {
+                sqr(md, res, res);
+            }
+            mul(md, res, MONTG_TABLE(value >> 1), res);
+        } else {
+            memcpy(res, MONTG_TABLE(value >> 1), size);
+            started = 1;
+        }
+        pos = low;
+    }
+#undef MONTG_TABLE
+}
+
+static void montg_pow_window_loop(const montg_t *md, const bignum_t *b, const bignum_t *exp, bignum_t *res, const size_t count,
+                                  const montg_mul_t mul, const montg_sqr_t sqr)
+{
+    bignum_t table[1 << (MONTG_WINDOW_MAX - 1)], b2;
+    montg_pow_window_run(md, b, exp, res, count * BN_WORD_SIZE, MONTG_WINDOW_MAX, table, &b2, mul, sqr);
+}
+
+// Вход и выход в домене R; для IFMA основание переводится в R' и обратно
+static void montg_pow_engine(const montg_t *md, const bignum_t *b, const bignum_t *exp, bignum_t *res, const montg_pow_loop_t loop) {
+    if (md->shift == 0) {
+        return;
+    }
+
+    if (bn_is_zero(exp, BN_ARRAY_SIZE)) {
+        bn_assign(res, 0, &md->r, 0, md->shift * 2);
+        return;
+    }
+
+    if (md->engine == MONTG_ENGINE_IFMA) {
+        // x * R -> x * R': (x * R) * c_in / R' = x * R'
+        bignum_t b_ifma, res_ifma;
+        montg_ifma_from_bn(md, b, &b_ifma);
+        montg_ifma_mul(md, &b_ifma, &md->ifma_c_in, &b_ifma);
+
+        loop(md, &b_ifma, exp, &res_ifma, md->ifma_digits, montg_ifma_mul, montg_sqr_ifma);
+
+        montg_ifma_mul(md, &res_ifma, &md->ifma_c_out, &res_ifma);
+        montg_ifma_to_bn(md, &res_ifma, res);
+        return;
+    }
+
+    loop(md, b, exp, res, md->shift * 2, montg_mul_scalar, montg_sqr_scalar);
+}
+
+void montg_pow(const montg_t *md, const bignum_t *b, const bignum_t *exp, bignum_t *res) {
+    montg_pow_engine(md, b, exp, res, montg_pow_window_loop);
+}
+
+void montg_pow_binary(const montg_t *md, const bignum_t *b, const bignum_t *exp, bignum_t *res) {
+    montg_pow_engine(md, b, exp, res, montg_pow_binary_loop);
+}
+
+// Слева направо по битам exp, кроме младшего: при нечётном exp последнее умножение
+// на val в обычном виде сразу выводит результат из домена (x^(exp - 1) * R * val / R)
+static void montg_pow_small_loop(const montg_t *md, const bignum_t *val, const bignum_t *val_montg, const uint32_t exp,
+                                 bignum_t *res, const bignum_t *one, const montg_mul_t mul, const montg_sqr_t sqr, const size_t count)
+{
+    size_t bit = 31 - __builtin_clz(exp);
+    bn_assign(res, 0, val_montg, 0, count);
+
+    while (bit-- > 1) {
+        sqr(md, res, res);
+        if ((exp >> bit) & 1) {
+            mul(md, res, val_montg, res);
+        }
+    }
+
+    if (exp > 1) {
+        sqr(md, res, res);
+    }
+    mul(md, res, exp & 1 ? val : one, res);
+}
+
+// Основание в обычном виде на shift * 2 разрядах, приведённое по модулю целиком: операнды движков
+// должны быть меньше модуля, а обрезка до shift разрядов была бы приведением по R, а не по n
+static void montg_reduce_base(const montg_t *md, const bignum_t *val, bignum_t *res) {
+    const size_t size = md->shift * 2;
+
+    if (bn_used_size(val, size) > md->shift || bn_cmp(val, &md->mod, md->shift) != BN_CMP_SMALLER) {
+        bn_mod(val, &md->mod, res, size);
+        return;
+    }
+
+    bn_assign(res, 0, val, 0, md->shift);
+    bn_memset(res, md->shift, 0, md->shift);
+}
+
+void montg_pow_small(const montg_t *md, const bignum_t *val, const uint32_t exp, bignum_t *res) {
+    const size_t size = md->shift * 2;
+    bignum_t base, base_montg, one;
+
+    if (md->shift == 0) {
+        return;
+    }
+
+    if (exp == 0) {
+        bn_from_int(res, 1, size);
+        return;
+    }
+
+    montg_reduce_base(md, val, &base);
+    if (exp == 1) {
+        bn_assign(res, 0, &base, 0, size);
+        return;
+    }
+
+    if (md->engine == MONTG_ENGINE_IFMA) {
+        bignum_t base_ifma, one_ifma, res_ifma;
+        bn_from_int(&one, 1, size);
+        montg_ifma_from_bn(md, &base, &base_ifma);
+        montg_ifma_from_bn(md, &one, &one_ifma);
+        montg_ifma_mul(md, &base_ifma, &md->ifma_r2, &base_montg);
+
+        montg_pow_small_loop(md, &base_ifma, &base_montg, exp, &res_ifma, &one_ifma, montg_ifma_mul, montg_sqr_ifma,
+                             md->ifma_digits);
+        montg_ifma_to_bn(md, &res_ifma, res);
+        return;
+    }
+
+    bn_from_int(&one, 1, size);
+    montg_mul_scalar(md, &base, &md->r2, &base_montg);
+    montg_pow_small_loop(md, &base, &base_montg, exp, res, &one, montg_mul_scalar, montg_sqr_scalar, size);
+}
+
+// Неполная последняя группа дополняется копиями первого числа группы
+void montg_pow_many(const montg_t *md, const bignum_t *vals, const bignum_t *exp, bignum_t *res, size_t count) {
+    const size_t size = md->shift * 2;
+
+    if (md->shift == 0) {
+        return;
+    }
+
+    if (!md->mb_use || bn_is_zero(exp, BN_ARRAY_SIZE)) {
+        for (size_t i = 0; i < count; ++i) {
+            bignum_t val, val_montg, res_montg = {0};
+            montg_reduce_base(md, &vals[i], &val);
+            montg_transform(md, &val, &val_montg);
+            montg_pow(md, &val_montg, exp, &res_montg);
+            montg_revert(md, &res_montg, &res[i]);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < count; i += MONTG_MB_LANES) {
+        bignum_t lanes_in[MONTG_MB_LANES], lanes_out[MONTG_MB_LANES];
+        const size_t lanes = MIN(count - i, (size_t)MONTG_MB_LANES);
+
+        for (size_t l = 0; l < MONTG_MB_LANES; ++l) {
+            montg_reduce_base(md, &vals[i + (l < lanes ? l : 0)], &lanes_in[l]);
+        }
+
+        montg_mb_pow(md, lanes_in, exp, lanes_out);
+        for (size_t l = 0; l < lanes; ++l) {
+            bn_assign(&res[i + l], 0, &lanes_out[l], 0, size);
+        }
+    }
+}
@@ -0,0 +1,239 @@
+#include "montgomery_ifma.h"
+#include "bignum.h"
+#include "montgomery.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef MONTG_IFMA_ENABLED
+
+#include <immintrin.h>
+
+#define IFMA_BITS 52
+#define IFMA_MASK (((uint64_t)1 << IFMA_BITS) - 1)
+#define IFMA_MAX_VECTORS (BN_ARRAY_SIZE / 8)
+#define IFMA_TARGET __attribute__((target("avx512f,avx512ifma")))
+
+int montg_ifma_supported(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512ifma");
+}
+
+// Разряды по 64 бита -> разряды по 52 бита, недостающие старшие биты считаются нулями
+static void ifma_from_words(const uint64_t *src, const size_t words, uint64_t *dst, const size_t digits) {
+    for (size_t j = 0; j < digits; ++j) {
+        const size_t bit = j * IFMA_BITS, limb = bit / 64, off = bit % 64;
+        uint64_t value = limb < words ? src[limb] >> off : 0;
+        if (off > 64 - IFMA_BITS && limb + 1 < words) {
+            value |= src[limb + 1] << (64 - off);
+        }
+        dst[j] = value & IFMA_MASK;
+    }
+}
+
+// Обратный перевод, dst должен быть обнулён
+static void ifma_to_words(const uint64_t *src, const size_t digits, uint64_t *dst, const size_t words) {
+    for (size_t j = 0; j < digits; ++j) {
+        const size_t bit = j * IFMA_BITS, limb = bit / 64, off = bit % 64;
+        if (limb < words) {
+            dst[limb] |= src[j] << off;
+        }
+        if (off > 64 - IFMA_BITS && limb + 1 < words) {
+            dst[limb + 1] |= src[j] >> (64 - off);
+        }
+    }
+}
+
+// Почти монтгомеровское умножение (Gueron, Krasnov): res = a * b / R' mod n в пределах [0, 2n).
+// Разряды накопителя не нормализуются до конца: за digits шагов каждый получает
+// не больше 4 * digits слагаемых меньше 2^52, что помещается в 64 бита.
+// При постоянном vectors циклы разворачиваются и накопитель живёт в регистрах
+IFMA_TARGET static inline __attribute__((always_inline))
+void ifma_amm(const uint64_t *a, const uint64_t *b, const uint64_t *n, const uint64_t n0, uint64_t *res, const size_t vectors) {
+    __m512i acc[IFMA_MAX_VECTORS], av[IFMA_MAX_VECTORS], nv[IFMA_MAX_VECTORS];
+    const __m512i zero = _mm512_setzero_si512();
+
+#pragma GCC unroll 16
+    for (size_t v = 0; v < vectors; ++v) {
+        acc[v] = zero;
+        av[v] = _mm512_loadu_si512(a + v * 8);
+        nv[v] = _mm512_loadu_si512(n + v * 8);
+    }
+
+    for (size_t i = 0; i < vectors * 8; ++i) {
+        const __m512i bi = _mm512_set1_epi64(b[i]);
+#pragma GCC unroll 16
+        for (size_t v = 0; v < vectors; ++v) {
+            acc[v] = _mm512_madd52lo_epu64(acc[v], av[v], bi);
+        }
+
+        const uint64_t m = ((uint64_t)_mm_cvtsi128_si64(_mm512_castsi512_si128(acc[0])) * n0) & IFMA_MASK;
+        const __m512i mi = _mm512_set1_epi64(m);
+#pragma GCC unroll 16
+        for (size_t v = 0; v < vectors; ++v) {
+            acc[v] = _mm512_madd52lo_epu64(acc[v], nv[v], mi);
+        }
+
+        // Младший разряд теперь делится на 2^52: сдвиг на разряд, перенос уходит в новый младший
+        const uint64_t carry = (uint64_t)_mm_cvtsi128_si64(_mm512_castsi512_si128(acc[0])) >> IFMA_BITS;
+#pragma GCC unroll 16
+        for (size_t v = 0; v + 1 < vectors; ++v) {
+            acc[v] = _mm512_alignr_epi64(acc[v + 1], acc[v], 1);
+        }
+        acc[vectors - 1] = _mm512_alignr_epi64(zero, acc[vectors - 1], 1);
+
+        // Старшие половины произведений относятся к следующему разряду, то есть после сдвига - к тому же
+#pragma GCC unroll 16
+        for (size_t v = 0; v < vectors; ++v) {
+            acc[v] = _mm512_madd52hi_epu64(acc[v], av[v], bi);
+            acc[v] = _mm512_madd52hi_epu64(acc[v], nv[v], mi);
+        }
+        acc[0] = _mm512_mask_add_epi64(acc[0], 1, acc[0], _mm512_set1_epi64(carry));
+    }
+
+#pragma GCC unroll 16
+    for (size_t v = 0; v < vectors; ++v) {
+        _mm512_storeu_si512(res + v * 8, acc[v]);
+    }
+}
+
+#define IFMA_AMM_FIXED(vectors)                                                                          \
+    IFMA_TARGET static void ifma_amm_##vectors(const uint64_t *a, const uint64_t *b, const uint64_t *n, \
+                                               const uint64_t n0, uint64_t *res) {                     \
+        ifma_amm(a, b, n, n0, res, vectors);                                                            \
+    }
+
+IFMA_AMM_FIXED(1)
+IFMA_AMM_FIXED(2)
+IFMA_AMM_FIXED(3)
+IFMA_AMM_FIXED(4)
+IFMA_AMM_FIXED(5)
+IFMA_AMM_FIXED(6)
+IFMA_AMM_FIXED(8)
+IFMA_AMM_FIXED(10)
+
+IFMA_TARGET static void ifma_amm_any(const uint64_t *a, const uint64_t *b, const uint64_t *n, const uint64_t n0, uint64_t *res, const size_t vectors) {
+    ifma_amm(a, b, n, n0, res, vectors);
+}
+
+// Перенос между разрядами и вычитание n, если результат AMM не меньше n
+static void ifma_normalize(uint64_t *res, const uint64_t *n, const size_t digits) {
+    uint64_t carry = 0;
+    for (size_t j = 0; j < digits; ++j) {
+        res[j] += carry;
+        carry = res[j] >> IFMA_BITS;
+        res[j] &= IFMA_MASK;
+    }
+
+    size_t j = digits;
+    while (j > 0 && res[j - 1] == n[j - 1]) {
+        --j;
+    }
+    if (j != 0 && res[j - 1] < n[j - 1]) {
+        return;
+    }
+
+    uint64_t borrow = 0;
+    for (j = 0; j < digits; ++j) {
+        const uint64_t tmp = res[j] - n[j] - borrow;
+        borrow = tmp >> 63;
+        res[j] = tmp & IFMA_MASK;
+    }
+}
+
+void montg_ifma_mul(const montg_t *md, const bignum_t *lhs, const bignum_t *rhs, bignum_t *res) {
+    const uint64_t *a = *lhs, *b = *rhs, *n = md->ifma_mod;
+    uint64_t *out = *res;
+
+    switch (md->ifma_digits / 8) {
+        case 1: ifma_amm_1(a, b, n, md->ifma_n0, out); break;
+        case 2: ifma_amm_2(a, b, n, md->ifma_n0, out); break;
+        case 3: ifma_amm_3(a, b, n, md->ifma_n0, out); break;
+        case 4: ifma_amm_4(a, b, n, md->ifma_n0, out); break;
+        case 5: ifma_amm_5(a, b, n, md->ifma_n0, out); break;
+        case 6: ifma_amm_6(a, b, n, md->ifma_n0, out); break;
+        case 8: ifma_amm_8(a, b, n, md->ifma_n0, out); break;
+        case 10: ifma_amm_10(a, b, n, md->ifma_n0, out); break;
+        default: ifma_amm_any(a, b, n, md->ifma_n0, out, md->ifma_digits / 8); break;
+    }
+
+    ifma_normalize(out, n, md->ifma_digits);
+}
+
+void montg_ifma_from_bn(const montg_t *md, const bignum_t *val, bignum_t *res) {
+    ifma_from_words(*val, md->shift, *res, md->ifma_digits);
+}
+
+void montg_ifma_to_bn(const montg_t *md, const bignum_t *val, bignum_t *res) {
+    bn_init(res, md->shift * 2);
+    ifma_to_words(*val, md->ifma_digits, *res, md->shift);
+}
+
+// res = 2^bits mod n, сдвиги не больше чем на домен за раз
+static void ifma_pow2_mod(const montg_t *md, size_t bits, bignum_t *res) {
+    const size_t size = md->shift * 2;
+    bn_from_int(res, 1, size);
+    while (bits > 0) {
+        const size_t step = MIN(bits, (size_t)md->shift * 64);
+        bn_lshift(res, res, step, size);
+        bn_mod(res, &md->mod, res, size);
+        bits -= step;
+    }
+}
+
+void montg_ifma_init(montg_t *md) {
+    md->ifma_digits = 0;
+
+    // R' > 2n, чтобы результат AMM помещался в разряды
+    const size_t bits = bn_bitcount(&md->mod);
+    const size_t digits = ((bits + IFMA_BITS) / IFMA_BITS + 7) / 8 * 8;
+    if (digits > BN_ARRAY_SIZE || digits * IFMA_BITS > BN_ARRAY_SIZE * 64) {
+        return;
+    }
+
+    // -n^-1 mod 2^64 по модулю 2^52 - это -n^-1 mod 2^52
+    md->ifma_n0 = md->n0 & IFMA_MASK;
+
+    bignum_t r_mod, c;
+    ifma_pow2_mod(md, digits * IFMA_BITS, &r_mod);
+    montg_mul(md, &r_mod, &r_mod, &c);
+    bn_init(&md->ifma_c_in, BN_ARRAY_SIZE);
+    ifma_from_words(c, md->shift, md->ifma_c_in, digits);
+
+    // c * R^2 / R = R'^2 mod n
+    montg_mul(md, &c, &md->r2, &c);
+    bn_init(&md->ifma_r2, BN_ARRAY_SIZE);
+    ifma_from_words(c, md->shift, md->ifma_r2, digits);
+
+    bn_init(&md->ifma_c_out, BN_ARRAY_SIZE);
+    ifma_from_words(md->r, md->shift, md->ifma_c_out, digits);
+
+    bn_init(&md->ifma_mod, BN_ARRAY_SIZE);
+    ifma_from_words(md->mod, md->shift, md->ifma_mod, digits);
+
+    md->ifma_digits = digits;
+}
+
+#else
+
+int montg_ifma_supported(void) {
+    return 0;
+}
+
+void montg_ifma_init(montg_t *md) {
+    md->ifma_digits = 0;
+}
+
+void montg_ifma_mul(const montg_t *md, const bignum_t *lhs, const bignum_t *rhs, bignum_t *res) {
+    (void)md, (void)lhs, (void)rhs, (void)res;
+}
+
+void montg_ifma_from_bn(const montg_t *md, const bignum_t *val, bignum_t *res) {
+    (void)md, (void)val, (void)res;
+}
+
+void montg_ifma_to_bn(const montg_t *md, const bignum_t *val, bignum_t *res) {
+    (void)md, (void)val, (void)res;
+}
+
+#endif
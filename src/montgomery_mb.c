@@ -0,0 +1,208 @@
+#include "montgomery_mb.h"
+#include "bignum.h"
+#include "montgomery.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef MONTG_MB_ENABLED
+
+#include <immintrin.h>
+
+#define MB_MASK (((uint64_t)1 << MONTG_MB_BITS) - 1)
+#define MB_WINDOW_MAX 5
+#define MB_TARGET __attribute__((target("avx2")))
+
+// Число из MONTG_MB_LANES независимых значений: разряд j числа l лежит в d[j * MONTG_MB_LANES + l],
+// так что один __m256i - один разряд всех чисел
+typedef struct {
+    uint64_t d[MONTG_MB_MAX_DIGITS * MONTG_MB_LANES];
+} __attribute__((aligned(32))) mb_num_t;
+
+int montg_mb_supported(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+// Разряд по 27 бит, начиная с бита bit; bignum читается как байты от младшего (x86 - little-endian)
+static uint64_t mb_get_digit(const uint8_t *bytes, const size_t nbytes, const size_t bit) {
+    uint64_t value = 0;
+    for (size_t k = 0; k < 5 && bit / 8 + k < nbytes; ++k) {
+        value |= (uint64_t)bytes[bit / 8 + k] << (k * 8);
+    }
+
+    return (value >> (bit % 8)) & MB_MASK;
+}
+
+// Обратная операция, bytes должен быть обнулён; разряд нормализован (меньше 2^27)
+static void mb_put_digit(uint8_t *bytes, const size_t nbytes, const size_t bit, const uint64_t digit) {
+    const uint64_t value = digit << (bit % 8);
+    for (size_t k = 0; k < 5 && bit / 8 + k < nbytes; ++k) {
+        bytes[bit / 8 + k] |= (uint8_t)(value >> (k * 8));
+    }
+}
+
+static void mb_from_bn(const montg_t *md, const bignum_t *val, mb_num_t *res, const size_t lane) {
+    for (size_t j = 0; j < md->mb_digits; ++j) {
+        res->d[j * MONTG_MB_LANES + lane] = mb_get_digit((const uint8_t *)*val, md->shift_byte_size, j * MONTG_MB_BITS);
+    }
+}
+
+static void mb_to_bn(const montg_t *md, const mb_num_t *val, bignum_t *res, const size_t lane) {
+    bn_init(res, md->shift * 2);
+    for (size_t j = 0; j < md->mb_digits; ++j) {
+        mb_put_digit((uint8_t *)*res, md->shift_byte_size, j * MONTG_MB_BITS, val->d[j * MONTG_MB_LANES + lane]);
+    }
+}
+
+// Константа домена во все числа
+static void mb_broadcast(const montg_t *md, const uint32_t *digits, mb_num_t *res) {
+    memset(res, 0, sizeof(*res));
+    for (size_t j = 0; j < md->mb_digits; ++j) {
+        for (size_t l = 0; l < MONTG_MB_LANES; ++l) {
+            res->d[j * MONTG_MB_LANES + l] = digits[j];
+        }
+    }
+}
+
+// Почти монтгомеровское умножение всех чисел сразу: res = a * b / R'' mod n в пределах [0, 2n)
+// для a, b < 2n (R'' >= 4n). _mm256_mul_epu32 умножает младшие 32 бита: произведение разрядов
+// меньше 2^54, и за digits шагов разряд накопителя получает не больше 2 * digits таких слагаемых,
+// что при digits <= 256 помещается в 64 бита; переносы распространяются один раз в конце.
+// Модуль общий для всех чисел, его разряд берётся из md->mb_mod во все позиции.
+// Накопитель не сдвигается: на шаге i младшим разрядом считается acc[i]
+MB_TARGET static void mb_amm(const montg_t *md, const mb_num_t *a, const mb_num_t *b, mb_num_t *res) {
+    const size_t digits = md->mb_digits;
+    const __m256i mask = _mm256_set1_epi64x(MB_MASK), n0 = _mm256_set1_epi64x(md->mb_n0);
+    __m256i acc[MONTG_MB_MAX_DIGITS * 2 + 1];
+    const __m256i *av = (const __m256i *)a->d, *bv = (const __m256i *)b->d;
+
+    for (size_t j = 0; j <= digits * 2; ++j) {
+        acc[j] = _mm256_setzero_si256();
+    }
+
+    for (size_t i = 0; i < digits; ++i) {
+        const __m256i bi = _mm256_load_si256(bv + i);
+        __m256i *t = acc + i;
+
+        const __m256i t0 = _mm256_add_epi64(t[0], _mm256_mul_epu32(_mm256_load_si256(av), bi));
+        const __m256i m = _mm256_and_si256(_mm256_mul_epu32(t0, n0), mask);
+        t[0] = _mm256_add_epi64(t0, _mm256_mul_epu32(_mm256_set1_epi64x(md->mb_mod[0]), m));
+
+        for (size_t j = 1; j < digits; ++j) {
+            const __m256i ab = _mm256_mul_epu32(_mm256_load_si256(av + j), bi);
+            const __m256i nm = _mm256_mul_epu32(_mm256_set1_epi64x(md->mb_mod[j]), m);
+            t[j] = _mm256_add_epi64(t[j], _mm256_add_epi64(ab, nm));
+        }
+
+        // Младший разряд делится на 2^27, его старшая часть переносится в следующий
+        t[1] = _mm256_add_epi64(t[1], _mm256_srli_epi64(t[0], MONTG_MB_BITS));
+    }
+
+    __m256i carry = _mm256_setzero_si256();
+    __m256i *out = (__m256i *)res->d;
+    for (size_t j = 0; j < digits; ++j) {
+        const __m256i value = _mm256_add_epi64(acc[digits + j], carry);
+        _mm256_store_si256(out + j, _mm256_and_si256(value, mask));
+        carry = _mm256_srli_epi64(value, MONTG_MB_BITS);
+    }
+    for (size_t j = digits; j < MONTG_MB_MAX_DIGITS; ++j) {
+        _mm256_store_si256(out + j, _mm256_setzero_si256());
+    }
+}
+
+static void mb_mul(const montg_t *md, const bignum_t *lhs, const bignum_t *rhs, bignum_t *res) {
+    mb_amm(md, (const mb_num_t *)lhs, (const mb_num_t *)rhs, (mb_num_t *)res);
+}
+
+static void mb_sqr(const montg_t *md, const bignum_t *val, bignum_t *res) {
+    mb_amm(md, (const mb_num_t *)val, (const mb_num_t *)val, (mb_num_t *)res);
+}
+
+void montg_mb_pow(const montg_t *md, const bignum_t *vals, const bignum_t *exp, bignum_t *res) {
+    const size_t size = md->shift * 2;
+    // Таблица окна на стеке, как у скалярного montg_pow: числа движка не длиннее MONTG_MB_MAX_BITS,
+    // и при окне не шире MB_WINDOW_MAX таблица занимает около 20 КБ
+    mb_num_t table[1 << (MB_WINDOW_MAX - 1)], r2, one, x, y, b2;
+
+    mb_broadcast(md, md->mb_r2, &r2);
+    memset(&x, 0, sizeof(x));
+    memset(&one, 0, sizeof(one));
+    for (size_t l = 0; l < MONTG_MB_LANES; ++l) {
+        mb_from_bn(md, &vals[l], &x, l);
+        one.d[l] = 1;
+    }
+
+    // x -> x * R'', возведение в степень, x * R'' -> x; последнее даёт не больше n.
+    // Показатель общий, поэтому ветвления окна одинаковы для всех чисел
+    mb_amm(md, &x, &r2, &x);
+    montg_pow_window_run(md, (const bignum_t *)&x, exp, (bignum_t *)&y, sizeof(mb_num_t), MB_WINDOW_MAX,
+                         (bignum_t *)table, (bignum_t *)&b2, mb_mul, mb_sqr);
+    mb_amm(md, &y, &one, &y);
+
+    for (size_t l = 0; l < MONTG_MB_LANES; ++l) {
+        mb_to_bn(md, &y, &res[l], l);
+        if (bn_cmp(&res[l], &md->mod, size) != BN_CMP_SMALLER) {
+            bn_sub(&res[l], &md->mod, &res[l], size);
+        }
+    }
+}
+
+void montg_mb_init(montg_t *md) {
+    md->mb_digits = 0;
+    if (!montg_mb_supported()) {
+        return;
+    }
+
+    // R'' >= 4n, чтобы результат AMM оставался меньше 2n
+    const size_t bits = bn_bitcount(&md->mod);
+    const size_t digits = (bits + 2 + MONTG_MB_BITS - 1) / MONTG_MB_BITS;
+    // Модули длиннее MONTG_MB_MAX_BITS движок не берёт: для них он медленнее
+    if (digits > MONTG_MB_MAX_DIGITS) {
+        return;
+    }
+
+    // -n^-1 mod 2^27 итерациями Ньютона по младшим 32 битам
+    const uint32_t mod0 = (uint32_t)mb_get_digit((const uint8_t *)md->mod, md->shift_byte_size, 0) |
+                          (uint32_t)mb_get_digit((const uint8_t *)md->mod, md->shift_byte_size, MONTG_MB_BITS) << MONTG_MB_BITS;
+    uint32_t inv = mod0;
+    for (size_t i = 0; i < 4; ++i) {
+        inv *= 2 - mod0 * inv;
+    }
+    md->mb_n0 = (uint32_t)((0 - inv) & MB_MASK);
+
+    // R''^2 mod n = 2^(2 * 27 * digits) mod n, сдвиги не больше чем на домен за раз
+    const size_t size = md->shift * 2;
+    bignum_t r2;
+    bn_from_int(&r2, 1, size);
+    for (size_t left = digits * MONTG_MB_BITS * 2; left > 0;) {
+        const size_t step = MIN(left, (size_t)md->shift * BN_WORD_SIZE * 8);
+        bn_lshift(&r2, &r2, step, size);
+        bn_mod(&r2, &md->mod, &r2, size);
+        left -= step;
+    }
+
+    md->mb_digits = digits;
+    memset(md->mb_mod, 0, sizeof(md->mb_mod));
+    memset(md->mb_r2, 0, sizeof(md->mb_r2));
+    for (size_t j = 0; j < digits; ++j) {
+        md->mb_mod[j] = (uint32_t)mb_get_digit((const uint8_t *)md->mod, md->shift_byte_size, j * MONTG_MB_BITS);
+        md->mb_r2[j] = (uint32_t)mb_get_digit((const uint8_t *)r2, md->shift_byte_size, j * MONTG_MB_BITS);
+    }
+}
+
+#else
+
+int montg_mb_supported(void) {
+    return 0;
+}
+
+void montg_mb_init(montg_t *md) {
+    md->mb_digits = 0;
+}
+
+void montg_mb_pow(const montg_t *md, const bignum_t *vals, const bignum_t *exp, bignum_t *res) {
+    (void)md, (void)vals, (void)exp, (void)res;
+}
+
+#endif
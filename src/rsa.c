@@ -1,14 +1,31 @@
 #include "rsa.h"
 
+#include <pthread.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
+#include <sys/uio.h>
 
 #include "asn1.h"
+#include "barrett.h"
 #include "base64.h"
 #include "bignum.h"
 #include "montgomery.h"
 
+// Показатель, если он помещается в 32 бита, иначе 0
+static uint32_t rsa_small_exp(const bignum_t *exp) {
+    if (bn_bitcount(exp) > 32) {
+        return 0;
+    }
+
+    uint32_t value = 0;
+    for (size_t i = 0; i * BN_WORD_SIZE < sizeof(uint32_t); ++i) {
+        value |= (uint32_t)((uint64_t)(*exp)[i] << (i * BN_WORD_SIZE * 8));
+    }
+
+    return value;
+}
+
 void import_pub_key(rsa_pub_key_t *key, const char *data) {
     const char begin[] = "-----BEGIN PUBLIC KEY-----";
     const char end[] = "-----END PUBLIC KEY-----";
@@ -50,6 +67,8 @@ void import_pub_key(rsa_pub_key_t *key, const char *data) {
         }
         bn_from_bytes(&key->pub_exp, int_ptr, int_size);
         read_ptr += read_size;
+
+        key->pub_exp_small = rsa_small_exp(&key->pub_exp);
     }
 }
 
@@ -105,9 +124,17 @@ void import_pvt_key(rsa_pvt_key_t *key, const char *data) {
         bn_from_bytes(targets[i], int_ptr, int_size);
         read_ptr += read_size;
     }
+
+    barrett_init(&key->barrett_p, &key->p);
+    barrett_init(&key->barrett_q, &key->q);
 }
 
 static void encrypt(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const bignum_t *bignum_in, bignum_t *bignum_out) {
+    if (key->pub_exp_small) {
+        montg_pow_small(montg_domain_n, bignum_in, key->pub_exp_small, bignum_out);
+        return;
+    }
+
     bignum_t bignum_montg_in, bignum_montg_out = {0};
 
     montg_transform(montg_domain_n, bignum_in, &bignum_montg_in);
@@ -117,40 +144,199 @@ static void encrypt(const rsa_pub_key_t *key, const montg_t *montg_domain_n, con
 }
 
 void encrypt_buf(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const char *buffer_in, size_t buffer_in_len, char *buffer_out, size_t buffer_out_len) {
-    bignum_t in_bn = {0}, out_bn;
+    bignum_t in_bn = {0}, out_bn = {0};
+
+    if (montg_domain_n->shift == 0) {
+        return;
+    }
 
-    memmove(in_bn, buffer_in, buffer_in_len * sizeof(char));
+    memmove(in_bn, buffer_in, MIN(buffer_in_len, montg_domain_n->shift_byte_size) * sizeof(char));
     encrypt(key, montg_domain_n, &in_bn, &out_bn);
     bn_to_string(&out_bn, buffer_out, buffer_out_len);
 }
 
-static void decrypt(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const montg_t *montg_domain_p, const montg_t *montg_domain_q, const bignum_t *bignum_in, bignum_t *bignum_out) {
-    bignum_t bignum_montg_p_in, bignum_montg_q_in, bignum_montg_p_out = {0}, bignum_montg_q_out = {0}, bignum_p_out, bignum_q_out, h, hq;
+// Приведение по Барретту, если значение укладывается в 2k разрядов контекста, иначе bn_mod
+static void rsa_reduce(const barrett_t *ctx, const bignum_t *val, bignum_t *res, const size_t size) {
+    if (ctx->k && bn_used_size(val, size) <= ctx->k * 2) {
+        barrett_reduce(ctx, val, res);
+    } else {
+        bn_mod(val, &ctx->mod, res, size);
+    }
+}
+
+// Garner: h = coeff * (m_p - m_q) mod p, m = m_q + h * q; bignum_p_out портится
+static void decrypt_crt(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const montg_t *montg_domain_p, bignum_t *bignum_p_out, const bignum_t *bignum_q_out, bignum_t *bignum_out) {
+    const size_t size = montg_domain_n->shift * 2;
+    bignum_t coeff = {0}, h = {0}, hq = {0}, tmp = {0};
+
+    rsa_reduce(&key->barrett_p, bignum_q_out, &tmp, size);
+    if (bn_cmp(bignum_p_out, &tmp, size) == BN_CMP_SMALLER) {
+        bn_add(bignum_p_out, &key->p, bignum_p_out, size);
+    }
+    bn_sub(bignum_p_out, &tmp, bignum_p_out, size);
+
+    montg_transform(montg_domain_p, &key->coeff, &coeff);
+    montg_mul(montg_domain_p, &coeff, bignum_p_out, &h);
+    bn_karatsuba(&h, &key->q, &hq, size);
+    // montg_mul приводит результат, поэтому h < p и m <= (q - 1) + (p - 1) * q < n: вычитать n не нужно
+    bn_add(bignum_q_out, &hq, bignum_out, size);
+}
+
+// Половина CRT: m_x = (c mod x)^exp mod x в домене x, результат в обычном виде
+static void decrypt_half(const montg_t *montg_domain, const barrett_t *barrett, const bignum_t *exp, const bignum_t *bignum_in, bignum_t *bignum_out, const size_t size) {
+    bignum_t bignum_x_in = {0}, bignum_montg_in, bignum_montg_out = {0};
+
+    // Домены p и q меньше домена n, поэтому сообщение сначала приводится по модулю
+    rsa_reduce(barrett, bignum_in, &bignum_x_in, size);
+    montg_transform(montg_domain, &bignum_x_in, &bignum_montg_in);
+    montg_pow(montg_domain, &bignum_montg_in, exp, &bignum_montg_out);
+    montg_revert(montg_domain, &bignum_montg_out, bignum_out);
+}
+
+// Постоянный вспомогательный поток для второй половины CRT: одно задание за раз,
+// вызывающий поток считает первую половину и ждёт done перед сборкой по Гарнеру
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t job_cond;
+    pthread_cond_t done_cond;
+    pthread_t thread;
+    uint8_t running;
+    uint8_t busy;               // задание выдано и ещё не забрано вызывающим
+    uint8_t has_job;
+    uint8_t done;
+
+    const montg_t *montg_domain;
+    const barrett_t *barrett;
+    const bignum_t *exp;
+    const bignum_t *bignum_in;
+    bignum_t *bignum_out;
+    size_t size;
+} rsa_crt_helper_t;
+
+static rsa_crt_helper_t rsa_crt_helper = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .job_cond = PTHREAD_COND_INITIALIZER,
+    .done_cond = PTHREAD_COND_INITIALIZER,
+};
+
+static void *rsa_crt_helper_main(void *arg) {
+    rsa_crt_helper_t *helper = arg;
+
+    pthread_mutex_lock(&helper->lock);
+    for (;;) {
+        while (helper->running && !helper->has_job) {
+            pthread_cond_wait(&helper->job_cond, &helper->lock);
+        }
+        if (!helper->has_job) {
+            break;
+        }
+        helper->has_job = 0;
+        pthread_mutex_unlock(&helper->lock);
+
+        decrypt_half(helper->montg_domain, helper->barrett, helper->exp, helper->bignum_in, helper->bignum_out, helper->size);
+
+        pthread_mutex_lock(&helper->lock);
+        helper->done = 1;
+        pthread_cond_signal(&helper->done_cond);
+    }
+    pthread_mutex_unlock(&helper->lock);
+
+    return NULL;
+}
+
+int rsa_set_parallel_crt(int enable) {
+    rsa_crt_helper_t *helper = &rsa_crt_helper;
+    int status = 0;
+
+    pthread_mutex_lock(&helper->lock);
+    if (enable && !helper->running) {
+        helper->running = 1;
+        if (pthread_create(&helper->thread, NULL, rsa_crt_helper_main, helper) != 0) {
+            helper->running = 0;
+            status = -1;
+        }
+        pthread_mutex_unlock(&helper->lock);
+        return status;
+    }
+    if (enable || !helper->running) {
+        pthread_mutex_unlock(&helper->lock);
+        return 0;
+    }
+
+    // Задание, выданное до выключения, досчитывается: поток выходит, только когда has_job = 0
+    helper->running = 0;
+    pthread_cond_signal(&helper->job_cond);
+    pthread_mutex_unlock(&helper->lock);
+    pthread_join(helper->thread, NULL);
+
+    return 0;
+}
+
+// 0, если поток выключен или занят другим вызовом: тогда половина считается на месте
+static uint8_t rsa_crt_helper_submit(const montg_t *montg_domain, const barrett_t *barrett, const bignum_t *exp, const bignum_t *bignum_in, bignum_t *bignum_out, const size_t size) {
+    rsa_crt_helper_t *helper = &rsa_crt_helper;
+
+    pthread_mutex_lock(&helper->lock);
+    if (!helper->running || helper->busy) {
+        pthread_mutex_unlock(&helper->lock);
+        return 0;
+    }
 
-    montg_transform(montg_domain_p, bignum_in, &bignum_montg_p_in);
-    montg_pow(montg_domain_p, &bignum_montg_p_in, &key->exp1, &bignum_montg_p_out);
-    montg_revert(montg_domain_p, &bignum_montg_p_out, &bignum_p_out);
+    helper->montg_domain = montg_domain;
+    helper->barrett = barrett;
+    helper->exp = exp;
+    helper->bignum_in = bignum_in;
+    helper->bignum_out = bignum_out;
+    helper->size = size;
+    helper->busy = helper->has_job = 1;
+    helper->done = 0;
+    pthread_cond_signal(&helper->job_cond);
+    pthread_mutex_unlock(&helper->lock);
+
+    return 1;
+}
 
-    montg_transform(montg_domain_q, bignum_in, &bignum_montg_q_in);
-    montg_pow(montg_domain_q, &bignum_montg_q_in, &key->exp2, &bignum_montg_q_out);
-    montg_revert(montg_domain_q, &bignum_montg_q_out, &bignum_q_out);
+static void rsa_crt_helper_wait(void) {
+    rsa_crt_helper_t *helper = &rsa_crt_helper;
 
-    bn_sub(&bignum_p_out, &bignum_q_out, &bignum_p_out, BN_ARRAY_SIZE);
-    montg_mul(montg_domain_p, &key->coeff, &bignum_p_out, &h);
-    montg_mul(montg_domain_n, &h, &key->q, &hq);
-    bn_add(&bignum_q_out, &hq, bignum_out, BN_ARRAY_SIZE);
+    pthread_mutex_lock(&helper->lock);
+    while (!helper->done) {
+        pthread_cond_wait(&helper->done_cond, &helper->lock);
+    }
+    helper->busy = 0;
+    pthread_mutex_unlock(&helper->lock);
+}
+
+// Домены не инициализированы (shift = 0), если модуль не поместился в bignum_t
+static uint8_t rsa_domains_ready(const montg_t *montg_domain_n, const montg_t *montg_domain_p, const montg_t *montg_domain_q) {
+    return montg_domain_n->shift != 0 && montg_domain_p->shift != 0 && montg_domain_q->shift != 0;
+}
 
-    while (bn_cmp(bignum_out, &key->mod, BN_ARRAY_SIZE) != BN_CMP_SMALLER) {
-        bn_sub(bignum_out, &key->mod, bignum_out, BN_ARRAY_SIZE);
+static void decrypt(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const montg_t *montg_domain_p, const montg_t *montg_domain_q, const bignum_t *bignum_in, bignum_t *bignum_out) {
+    const size_t size = montg_domain_n->shift * 2;
+    bignum_t bignum_p_out = {0}, bignum_q_out = {0};
+
+    const uint8_t parallel = rsa_crt_helper_submit(montg_domain_q, &key->barrett_q, &key->exp2, bignum_in, &bignum_q_out, size);
+    decrypt_half(montg_domain_p, &key->barrett_p, &key->exp1, bignum_in, &bignum_p_out, size);
+    if (parallel) {
+        rsa_crt_helper_wait();
+    } else {
+        decrypt_half(montg_domain_q, &key->barrett_q, &key->exp2, bignum_in, &bignum_q_out, size);
     }
+
+    decrypt_crt(key, montg_domain_n, montg_domain_p, &bignum_p_out, &bignum_q_out, bignum_out);
 }
 
 void decrypt_buf(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const montg_t *montg_domain_p, const montg_t *montg_domain_q, const char *buffer_in, size_t buffer_in_len, char *buffer_out, size_t buffer_out_len) {
-    bignum_t in_bn = {0}, out_bn;
+    bignum_t in_bn = {0}, out_bn = {0};
+
+    if (!rsa_domains_ready(montg_domain_n, montg_domain_p, montg_domain_q)) {
+        return;
+    }
 
     bn_from_string(&in_bn, buffer_in, buffer_in_len);
     decrypt(key, montg_domain_n, montg_domain_p, montg_domain_q, &in_bn, &out_bn);
-    memmove(buffer_out, out_bn, buffer_out_len * sizeof(uint8_t));
+    memmove(buffer_out, out_bn, MIN(buffer_out_len, sizeof(bignum_t)) * sizeof(uint8_t));
 }
 
 static void sign(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const bignum_t *bignum_in, bignum_t *bignum_out) {
@@ -163,9 +349,13 @@ static void sign(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const
 }
 
 void sign_buf(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const char *buffer_in, size_t buffer_in_len, char *buffer_out, size_t buffer_out_len) {
-    bignum_t in_bn = {0}, out_bn;
+    bignum_t in_bn = {0}, out_bn = {0};
 
-    memmove(in_bn, buffer_in, buffer_in_len * sizeof(char));
+    if (montg_domain_n->shift == 0) {
+        return;
+    }
+
+    memmove(in_bn, buffer_in, MIN(buffer_in_len, montg_domain_n->shift_byte_size) * sizeof(char));
     sign(key, montg_domain_n, &in_bn, &out_bn);
     bn_to_string(&out_bn, buffer_out, buffer_out_len);
 }
@@ -173,9 +363,202 @@ void sign_buf(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const cha
 void verify_buf(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const char *buffer_in, size_t buffer_in_len, char *buffer_out, size_t buffer_out_len) {
 #define verify encrypt
     
-    bignum_t in_bn = {0}, out_bn;
+    bignum_t in_bn = {0}, out_bn = {0};
+
+    if (montg_domain_n->shift == 0) {
+        return;
+    }
 
     bn_from_string(&in_bn, buffer_in, buffer_in_len);
     verify(key, montg_domain_n, &in_bn, &out_bn);
-    memmove(buffer_out, out_bn, buffer_out_len * sizeof(uint8_t));
-}
\ No newline at end of file
+    memmove(buffer_out, out_bn, MIN(buffer_out_len, sizeof(bignum_t)) * sizeof(uint8_t));
+}
+
+size_t rsa_bin_len(const montg_t *montg_domain_n) {
+    return (bn_bitcount(&montg_domain_n->mod) + 7) / 8;
+}
+
+// OS2IP входа прямо из буферов вызывающего: не длиннее модуля и меньше n
+static int rsa_bin_in(const montg_t *montg_domain_n, const struct iovec *iov, size_t iovcnt, size_t out_len, bignum_t *bignum) {
+    const size_t len = rsa_bin_len(montg_domain_n);
+    size_t total = 0;
+
+    for (size_t i = 0; i < iovcnt; ++i) {
+        total += iov[i].iov_len;
+    }
+    if (total > len || out_len < len) {
+        return -1;
+    }
+
+    bn_from_iov(bignum, iov, iovcnt);
+    return bn_cmp(bignum, &montg_domain_n->mod, montg_domain_n->shift) == BN_CMP_SMALLER ? 0 : -1;
+}
+
+int encrypt_iov(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const struct iovec *iov, size_t iovcnt, uint8_t *out, size_t out_len) {
+    bignum_t in_bn, out_bn = {0};
+
+    if (rsa_bin_in(montg_domain_n, iov, iovcnt, out_len, &in_bn) != 0) {
+        return -1;
+    }
+    encrypt(key, montg_domain_n, &in_bn, &out_bn);
+    return bn_to_bytes(&out_bn, out, rsa_bin_len(montg_domain_n));
+}
+
+int decrypt_iov(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const montg_t *montg_domain_p, const montg_t *montg_domain_q, const struct iovec *iov, size_t iovcnt, uint8_t *out, size_t out_len) {
+    bignum_t in_bn, out_bn = {0};
+
+    if (rsa_bin_in(montg_domain_n, iov, iovcnt, out_len, &in_bn) != 0) {
+        return -1;
+    }
+    decrypt(key, montg_domain_n, montg_domain_p, montg_domain_q, &in_bn, &out_bn);
+    return bn_to_bytes(&out_bn, out, rsa_bin_len(montg_domain_n));
+}
+
+int sign_iov(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const struct iovec *iov, size_t iovcnt, uint8_t *out, size_t out_len) {
+    bignum_t in_bn, out_bn = {0};
+
+    if (rsa_bin_in(montg_domain_n, iov, iovcnt, out_len, &in_bn) != 0) {
+        return -1;
+    }
+    sign(key, montg_domain_n, &in_bn, &out_bn);
+    return bn_to_bytes(&out_bn, out, rsa_bin_len(montg_domain_n));
+}
+
+int verify_iov(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const struct iovec *iov, size_t iovcnt, uint8_t *out, size_t out_len) {
+    return encrypt_iov(key, montg_domain_n, iov, iovcnt, out, out_len);
+}
+
+int encrypt_bin(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len) {
+    const struct iovec iov = {(void *)in, in_len};
+    return encrypt_iov(key, montg_domain_n, &iov, 1, out, out_len);
+}
+
+int decrypt_bin(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const montg_t *montg_domain_p, const montg_t *montg_domain_q, const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len) {
+    const struct iovec iov = {(void *)in, in_len};
+    return decrypt_iov(key, montg_domain_n, montg_domain_p, montg_domain_q, &iov, 1, out, out_len);
+}
+
+int sign_bin(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len) {
+    const struct iovec iov = {(void *)in, in_len};
+    return sign_iov(key, montg_domain_n, &iov, 1, out, out_len);
+}
+
+int verify_bin(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len) {
+    const struct iovec iov = {(void *)in, in_len};
+    return verify_iov(key, montg_domain_n, &iov, 1, out, out_len);
+}
+
+// Открытый показатель для группы до MONTG_MB_LANES чисел; без многобуферного движка
+// короткий показатель выгоднее считать montg_pow_small по одному
+static void encrypt_lanes(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const bignum_t *bignums_in, bignum_t *bignums_out, const size_t lanes) {
+    if (!montg_domain_n->mb_use) {
+        for (size_t l = 0; l < lanes; ++l) {
+            encrypt(key, montg_domain_n, &bignums_in[l], &bignums_out[l]);
+        }
+        return;
+    }
+
+    montg_pow_many(montg_domain_n, bignums_in, &key->pub_exp, bignums_out, lanes);
+}
+
+void encrypt_many(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const char *const *buffers_in, const size_t *buffers_in_len, char *const *buffers_out, size_t buffer_out_len, size_t count) {
+    if (montg_domain_n->shift == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < count; i += MONTG_MB_LANES) {
+        const size_t lanes = MIN(count - i, (size_t)MONTG_MB_LANES);
+        bignum_t in_bn[MONTG_MB_LANES] = {{0}}, out_bn[MONTG_MB_LANES] = {{0}};
+
+        for (size_t l = 0; l < lanes; ++l) {
+            memmove(in_bn[l], buffers_in[i + l], MIN(buffers_in_len[i + l], montg_domain_n->shift_byte_size) * sizeof(char));
+        }
+        encrypt_lanes(key, montg_domain_n, in_bn, out_bn, lanes);
+        for (size_t l = 0; l < lanes; ++l) {
+            bn_to_string(&out_bn[l], buffers_out[i + l], buffer_out_len);
+        }
+    }
+}
+
+void decrypt_many(const rsa_pvt_key_t *key, const montg_t *montg_domain_n, const montg_t *montg_domain_p, const montg_t *montg_domain_q, const char *const *buffers_in, const size_t *buffers_in_len, char *const *buffers_out, size_t buffer_out_len, size_t count) {
+    const size_t size = montg_domain_n->shift * 2;
+
+    if (!rsa_domains_ready(montg_domain_n, montg_domain_p, montg_domain_q)) {
+        return;
+    }
+
+    for (size_t i = 0; i < count; i += MONTG_MB_LANES) {
+        const size_t lanes = MIN(count - i, (size_t)MONTG_MB_LANES);
+        bignum_t in_bn = {0}, out_bn = {0};
+        bignum_t p_in[MONTG_MB_LANES] = {{0}}, q_in[MONTG_MB_LANES] = {{0}}, p_out[MONTG_MB_LANES] = {{0}}, q_out[MONTG_MB_LANES] = {{0}};
+
+        for (size_t l = 0; l < lanes; ++l) {
+            bn_from_string(&in_bn, buffers_in[i + l], buffers_in_len[i + l]);
+            rsa_reduce(&key->barrett_p, &in_bn, &p_in[l], size);
+            rsa_reduce(&key->barrett_q, &in_bn, &q_in[l], size);
+        }
+
+        montg_pow_many(montg_domain_p, p_in, &key->exp1, p_out, lanes);
+        montg_pow_many(montg_domain_q, q_in, &key->exp2, q_out, lanes);
+
+        for (size_t l = 0; l < lanes; ++l) {
+            decrypt_crt(key, montg_domain_n, montg_domain_p, &p_out[l], &q_out[l], &out_bn);
+            memmove(buffers_out[i + l], out_bn, MIN(buffer_out_len, sizeof(bignum_t)) * sizeof(uint8_t));
+        }
+    }
+}
+
+// Подписи группы до MONTG_MB_LANES строк в числа и открытый показатель для них
+static void verify_lanes(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const char *const *buffers_in, const size_t *buffers_in_len, bignum_t *bignums_in, bignum_t *bignums_out, const size_t lanes) {
+    for (size_t l = 0; l < lanes; ++l) {
+        bn_from_string(&bignums_in[l], buffers_in[l], buffers_in_len[l]);
+    }
+    encrypt_lanes(key, montg_domain_n, bignums_in, bignums_out, lanes);
+}
+
+void verify_many(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const char *const *buffers_in, const size_t *buffers_in_len, char *const *buffers_out, size_t buffer_out_len, size_t count) {
+    if (montg_domain_n->shift == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < count; i += MONTG_MB_LANES) {
+        const size_t lanes = MIN(count - i, (size_t)MONTG_MB_LANES);
+        bignum_t in_bn[MONTG_MB_LANES] = {{0}}, out_bn[MONTG_MB_LANES] = {{0}};
+
+        verify_lanes(key, montg_domain_n, buffers_in + i, buffers_in_len + i, in_bn, out_bn, lanes);
+        for (size_t l = 0; l < lanes; ++l) {
+            memmove(buffers_out[i + l], out_bn[l], MIN(buffer_out_len, sizeof(bignum_t)) * sizeof(uint8_t));
+        }
+    }
+}
+
+int verify_batch(const rsa_pub_key_t *key, const montg_t *montg_domain_n, const char *const *sigs, const size_t *sigs_len, const char *const *msgs, const size_t *msgs_len, uint8_t *results, size_t count) {
+    int ret = 0;
+
+    if (montg_domain_n->shift == 0) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; i += MONTG_MB_LANES) {
+        const size_t lanes = MIN(count - i, (size_t)MONTG_MB_LANES);
+        bignum_t in_bn[MONTG_MB_LANES] = {{0}}, out_bn[MONTG_MB_LANES] = {{0}};
+
+        verify_lanes(key, montg_domain_n, sigs + i, sigs_len + i, in_bn, out_bn, lanes);
+        for (size_t l = 0; l < lanes; ++l) {
+            // Подпись не меньше n приводится по n и дала бы то же сообщение, что и s mod n, поэтому отвергается
+            bignum_t msg_bn = {0};
+            const uint8_t fits = msgs_len[i + l] <= montg_domain_n->shift_byte_size &&
+                                 bn_cmp(&in_bn[l], &montg_domain_n->mod, BN_ARRAY_SIZE) == BN_CMP_SMALLER;
+            if (fits) {
+                memmove(msg_bn, msgs[i + l], msgs_len[i + l] * sizeof(char));
+            }
+
+            results[i + l] = fits && bn_cmp(&out_bn[l], &msg_bn, BN_ARRAY_SIZE) == BN_CMP_EQUAL;
+            if (!results[i + l]) {
+                ret = -1;
+            }
+        }
+    }
+
+    return ret;
+}
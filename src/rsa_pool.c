@@ -0,0 +1,203 @@
+#include "rsa_pool.h"
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rsa.h"
+
+// Рабочие области умножений (bn_scratch и др.) уже _Thread_local, поэтому задания
+// разных потоков не делят ничего, кроме ключей только для чтения
+static void rsa_job_exec(const rsa_job_t *job) {
+    const rsa_keyset_t *keys = job->keys;
+
+    switch (job->op) {
+        case RSA_JOB_ENCRYPT:
+            encrypt_buf(keys->pub_key, keys->montg_domain_n, job->buffer_in, job->buffer_in_len, job->buffer_out, job->buffer_out_len);
+            break;
+        case RSA_JOB_DECRYPT:
+            decrypt_buf(keys->pvt_key, keys->montg_domain_n, keys->montg_domain_p, keys->montg_domain_q, job->buffer_in,
+                        job->buffer_in_len, job->buffer_out, job->buffer_out_len);
+            break;
+        case RSA_JOB_SIGN:
+            sign_buf(keys->pvt_key, keys->montg_domain_n, job->buffer_in, job->buffer_in_len, job->buffer_out, job->buffer_out_len);
+            break;
+        case RSA_JOB_VERIFY:
+            verify_buf(keys->pub_key, keys->montg_domain_n, job->buffer_in, job->buffer_in_len, job->buffer_out, job->buffer_out_len);
+            break;
+    }
+}
+
+// Своё задание с конца очереди; 0, если очередь пуста
+static uint8_t rsa_pool_pop(rsa_pool_worker_t *worker, size_t *job) {
+    uint8_t found = 0;
+
+    pthread_mutex_lock(&worker->lock);
+    if (worker->top < worker->bottom) {
+        *job = --worker->bottom;
+        found = 1;
+    }
+    pthread_mutex_unlock(&worker->lock);
+
+    return found;
+}
+
+// Половина (с округлением вверх) первой непустой чужой очереди, начиная с соседа;
+// забранный диапазон становится своей очередью
+static uint8_t rsa_pool_steal(rsa_pool_worker_t *worker) {
+    rsa_pool_t *pool = worker->pool;
+    const size_t self = (size_t)(worker - pool->workers);
+
+    for (size_t i = 1; i < pool->thread_count; ++i) {
+        rsa_pool_worker_t *victim = &pool->workers[(self + i) % pool->thread_count];
+        size_t top = 0, bottom = 0;
+
+        pthread_mutex_lock(&victim->lock);
+        if (victim->top < victim->bottom) {
+            top = victim->top;
+            bottom = top + (victim->bottom - victim->top + 1) / 2;
+            victim->top = bottom;
+        }
+        pthread_mutex_unlock(&victim->lock);
+
+        if (top < bottom) {
+            pthread_mutex_lock(&worker->lock);
+            worker->top = top;
+            worker->bottom = bottom;
+            ++worker->steals;
+            pthread_mutex_unlock(&worker->lock);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// Задания не порождают новых, поэтому поток, не нашедший работы ни у себя, ни у других,
+// заканчивает пакет: всё, что ещё не выполнено, уже в руках других потоков
+static void *rsa_pool_main(void *arg) {
+    rsa_pool_worker_t *worker = arg;
+    rsa_pool_t *pool = worker->pool;
+    size_t seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stop && pool->generation == seen) {
+            pthread_cond_wait(&pool->start_cond, &pool->lock);
+        }
+        if (pool->stop) {
+            break;
+        }
+        seen = pool->generation;
+        const rsa_job_t *jobs = pool->jobs;
+        pthread_mutex_unlock(&pool->lock);
+
+        size_t job;
+        do {
+            while (rsa_pool_pop(worker, &job)) {
+                rsa_job_exec(&jobs[job]);
+            }
+        } while (rsa_pool_steal(worker));
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->active == 0) {
+            pthread_cond_broadcast(&pool->done_cond);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+int rsa_pool_init(rsa_pool_t *pool, size_t threads) {
+    if (threads == 0 || threads > RSA_POOL_MAX_THREADS) {
+        return -1;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+    pool->generation = 0;
+    pool->active = 0;
+    pool->stop = 0;
+    pool->jobs = NULL;
+    pool->thread_count = 0;
+
+    for (size_t i = 0; i < threads; ++i) {
+        rsa_pool_worker_t *worker = &pool->workers[i];
+        pthread_mutex_init(&worker->lock, NULL);
+        worker->top = worker->bottom = 0;
+        worker->steals = 0;
+        worker->pool = pool;
+
+        if (pthread_create(&worker->thread, NULL, rsa_pool_main, worker) != 0) {
+            pthread_mutex_destroy(&worker->lock);
+            rsa_pool_destroy(pool);
+            return -1;
+        }
+        ++pool->thread_count;
+    }
+
+    return 0;
+}
+
+void rsa_pool_destroy(rsa_pool_t *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->start_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->thread_count; ++i) {
+        pthread_join(pool->workers[i].thread, NULL);
+        pthread_mutex_destroy(&pool->workers[i].lock);
+    }
+    pool->thread_count = 0;
+
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->start_cond);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+void rsa_pool_run(rsa_pool_t *pool, const rsa_job_t *jobs, size_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    // Предыдущий пакет другого вызывающего должен закончиться до раздачи очередей
+    while (pool->active != 0) {
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    }
+
+    const size_t threads = pool->thread_count;
+    for (size_t i = 0; i < threads; ++i) {
+        rsa_pool_worker_t *worker = &pool->workers[i];
+        pthread_mutex_lock(&worker->lock);
+        worker->top = count * i / threads;
+        worker->bottom = count * (i + 1) / threads;
+        pthread_mutex_unlock(&worker->lock);
+    }
+
+    pool->jobs = jobs;
+    pool->active = threads;
+    ++pool->generation;
+    pthread_cond_broadcast(&pool->start_cond);
+
+    const size_t generation = pool->generation;
+    while (pool->generation == generation && pool->active != 0) {
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+size_t rsa_pool_steals(rsa_pool_t *pool) {
+    size_t steals = 0;
+
+    for (size_t i = 0; i < pool->thread_count; ++i) {
+        pthread_mutex_lock(&pool->workers[i].lock);
+        steals += pool->workers[i].steals;
+        pthread_mutex_unlock(&pool->workers[i].lock);
+    }
+
+    return steals;
+}
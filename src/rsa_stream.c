@@ -0,0 +1,262 @@
+#include "rsa_stream.h"
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "bignum.h"
+#include "montgomery.h"
+#include "rsa.h"
+
+#define RSA_STREAM_PAD_MARK 0x80
+
+// Одна порция через многобуферные варианты: домены и рабочие области остаются те же от блока к блоку
+static void rsa_stream_process(const rsa_stream_t *stream, rsa_stream_slot_t *slot) {
+    const char *ins[RSA_STREAM_SLOT_BLOCKS];
+    char *outs[RSA_STREAM_SLOT_BLOCKS];
+    size_t in_lens[RSA_STREAM_SLOT_BLOCKS];
+
+    for (size_t i = 0; i < slot->blocks; ++i) {
+        ins[i] = slot->in[i];
+        outs[i] = slot->out[i];
+        in_lens[i] = stream->in_block;
+    }
+
+    if (stream->decrypt) {
+        decrypt_many(stream->pvt_key, stream->montg_domain_n, stream->montg_domain_p, stream->montg_domain_q, ins, in_lens,
+                     outs, stream->out_block, slot->blocks);
+    } else {
+        encrypt_many(stream->pub_key, stream->montg_domain_n, ins, in_lens, outs, sizeof(slot->out[0]), slot->blocks);
+    }
+}
+
+// Выдаёт результаты порции: шифротекст выравнивается нулями до длины блока,
+// расшифрованный блок выдаётся, только когда за ним есть следующий
+static size_t rsa_stream_flush(rsa_stream_t *stream, rsa_stream_slot_t *slot, char *out) {
+    size_t written = 0;
+
+    for (size_t i = 0; i < slot->blocks; ++i) {
+        if (stream->decrypt) {
+            if (stream->has_held) {
+                memcpy(out + written, stream->held, stream->out_block);
+                written += stream->out_block;
+            }
+            memcpy(stream->held, slot->out[i], stream->out_block);
+            stream->has_held = 1;
+            continue;
+        }
+
+        const size_t len = strlen(slot->out[i]);
+        memset(out + written, '0', stream->out_block - len);
+        memcpy(out + written + stream->out_block - len, slot->out[i], len);
+        written += stream->out_block;
+    }
+    slot->blocks = 0;
+
+    return written;
+}
+
+static void *rsa_stream_main(void *arg) {
+    rsa_stream_t *stream = arg;
+
+    pthread_mutex_lock(&stream->lock);
+    for (;;) {
+        while (!stream->stop && stream->job == NULL) {
+            pthread_cond_wait(&stream->job_cond, &stream->lock);
+        }
+        if (stream->job == NULL) {
+            break;
+        }
+        rsa_stream_slot_t *slot = stream->job;
+        pthread_mutex_unlock(&stream->lock);
+
+        rsa_stream_process(stream, slot);
+
+        pthread_mutex_lock(&stream->lock);
+        stream->job = NULL;
+        pthread_cond_signal(&stream->done_cond);
+    }
+    pthread_mutex_unlock(&stream->lock);
+
+    return NULL;
+}
+
+// Ждёт порцию, отданную потоку, и выдаёт её результаты
+static size_t rsa_stream_collect(rsa_stream_t *stream, char *out) {
+    if (!stream->in_flight) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&stream->lock);
+    while (stream->job != NULL) {
+        pthread_cond_wait(&stream->done_cond, &stream->lock);
+    }
+    pthread_mutex_unlock(&stream->lock);
+    stream->in_flight = 0;
+
+    return rsa_stream_flush(stream, &stream->slots[stream->filling ^ 1], out);
+}
+
+// Заполненная порция: в асинхронном режиме уходит потоку, и заполняться начинает вторая
+static size_t rsa_stream_submit(rsa_stream_t *stream, char *out) {
+    rsa_stream_slot_t *slot = &stream->slots[stream->filling];
+
+    if (!stream->async) {
+        rsa_stream_process(stream, slot);
+        return rsa_stream_flush(stream, slot, out);
+    }
+
+    const size_t written = rsa_stream_collect(stream, out);
+
+    pthread_mutex_lock(&stream->lock);
+    stream->job = slot;
+    pthread_cond_signal(&stream->job_cond);
+    pthread_mutex_unlock(&stream->lock);
+    stream->in_flight = 1;
+    stream->filling ^= 1;
+
+    return written;
+}
+
+static int rsa_stream_init(rsa_stream_t *stream, int async) {
+    stream->slots[0].blocks = stream->slots[1].blocks = 0;
+    stream->filling = 0;
+    stream->fill = 0;
+    stream->has_held = 0;
+    stream->in_flight = 0;
+    stream->stop = 0;
+    stream->job = NULL;
+    stream->async = async != 0;
+    if (!stream->async) {
+        return 0;
+    }
+
+    pthread_mutex_init(&stream->lock, NULL);
+    pthread_cond_init(&stream->job_cond, NULL);
+    pthread_cond_init(&stream->done_cond, NULL);
+    if (pthread_create(&stream->thread, NULL, rsa_stream_main, stream) != 0) {
+        pthread_cond_destroy(&stream->done_cond);
+        pthread_cond_destroy(&stream->job_cond);
+        pthread_mutex_destroy(&stream->lock);
+        stream->async = 0;
+        return -1;
+    }
+
+    return 0;
+}
+
+static void rsa_stream_stop(rsa_stream_t *stream) {
+    if (!stream->async) {
+        return;
+    }
+
+    pthread_mutex_lock(&stream->lock);
+    stream->stop = 1;
+    pthread_cond_signal(&stream->job_cond);
+    pthread_mutex_unlock(&stream->lock);
+    pthread_join(stream->thread, NULL);
+
+    pthread_cond_destroy(&stream->done_cond);
+    pthread_cond_destroy(&stream->job_cond);
+    pthread_mutex_destroy(&stream->lock);
+    stream->async = 0;
+}
+
+int rsa_stream_encrypt_init(rsa_stream_t *stream, const rsa_pub_key_t *key, const montg_t *montg_domain_n, int async) {
+    const size_t bits = bn_bitcount(&montg_domain_n->mod);
+
+    stream->decrypt = 0;
+    stream->pub_key = key;
+    stream->pvt_key = NULL;
+    stream->montg_domain_n = montg_domain_n;
+    stream->montg_domain_p = stream->montg_domain_q = NULL;
+    stream->in_block = (bits - 1) / 8;
+    stream->out_block = BN_BITS_TO_WORDS(bits) * BN_WORD_SIZE * 2;
+
+    return rsa_stream_init(stream, async);
+}
+
+int rsa_stream_decrypt_init(rsa_stream_t *stream, const rsa_pvt_key_t *key, const montg_t *montg_domain_n,
+                            const montg_t *montg_domain_p, const montg_t *montg_domain_q, int async) {
+    const size_t bits = bn_bitcount(&montg_domain_n->mod);
+
+    stream->decrypt = 1;
+    stream->pub_key = NULL;
+    stream->pvt_key = key;
+    stream->montg_domain_n = montg_domain_n;
+    stream->montg_domain_p = montg_domain_p;
+    stream->montg_domain_q = montg_domain_q;
+    stream->in_block = BN_BITS_TO_WORDS(bits) * BN_WORD_SIZE * 2;
+    stream->out_block = (bits - 1) / 8;
+
+    return rsa_stream_init(stream, async);
+}
+
+// Полные блоки входа, порция в потоке, заполняемая порция, придержанный блок и блок дополнения
+size_t rsa_stream_out_size(const rsa_stream_t *stream, size_t in_len) {
+    return (in_len / stream->in_block + RSA_STREAM_SLOT_BLOCKS * 2 + 2) * stream->out_block;
+}
+
+size_t rsa_stream_update(rsa_stream_t *stream, const char *in, size_t in_len, char *out) {
+    size_t written = 0;
+
+    while (in_len > 0) {
+        rsa_stream_slot_t *slot = &stream->slots[stream->filling];
+        const size_t count = MIN(stream->in_block - stream->fill, in_len);
+
+        memcpy(slot->in[slot->blocks] + stream->fill, in, count);
+        stream->fill += count;
+        in += count;
+        in_len -= count;
+
+        if (stream->fill == stream->in_block) {
+            stream->fill = 0;
+            if (++slot->blocks == RSA_STREAM_SLOT_BLOCKS) {
+                written += rsa_stream_submit(stream, out + written);
+            }
+        }
+    }
+
+    return written;
+}
+
+int rsa_stream_final(rsa_stream_t *stream, char *out, size_t *out_len) {
+    rsa_stream_slot_t *slot = &stream->slots[stream->filling];
+    size_t written = rsa_stream_collect(stream, out);
+    rsa_stream_stop(stream);
+
+    if (!stream->decrypt) {
+        char *block = slot->in[slot->blocks];
+        block[stream->fill] = (char)RSA_STREAM_PAD_MARK;
+        memset(block + stream->fill + 1, 0, stream->in_block - stream->fill - 1);
+        ++slot->blocks;
+        stream->fill = 0;
+    }
+
+    rsa_stream_process(stream, slot);
+    written += rsa_stream_flush(stream, slot, out + written);
+    *out_len = written;
+
+    if (!stream->decrypt) {
+        return 0;
+    }
+    if (stream->fill != 0 || !stream->has_held) {
+        return -1;
+    }
+
+    // Нули с конца последнего блока, затем метка дополнения
+    size_t len = stream->out_block;
+    while (len > 0 && stream->held[len - 1] == 0) {
+        --len;
+    }
+    if (len == 0 || (uint8_t)stream->held[len - 1] != RSA_STREAM_PAD_MARK) {
+        return -1;
+    }
+
+    memcpy(out + written, stream->held, len - 1);
+    *out_len = written + len - 1;
+    stream->has_held = 0;
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "barrett.h"
+#include <string.h>
+}
+
+// Сравнение с bn_mod на модулях разной длины; параметр - число разрядов модуля
+class BarrettTest : public testing::TestWithParam<size_t> {
+protected:
+    void SetUp() override {
+        const size_t words = GetParam();
+
+        srand(words);
+        bn_init(&mod, BN_ARRAY_SIZE);
+        for (size_t i = 0; i < words; ++i) {
+            mod[i] = (BN_DTYPE)rand() * (BN_DTYPE)rand();
+        }
+        mod[words - 1] |= 1;
+
+        barrett_init(&ctx, &mod);
+    }
+
+    void random_words(bignum_t *val, const size_t words) {
+        bn_init(val, BN_ARRAY_SIZE);
+        for (size_t i = 0; i < words; ++i) {
+            (*val)[i] = i % 7 == 0 ? (BN_DTYPE)BN_MAX_VAL : (BN_DTYPE)rand() * (BN_DTYPE)rand();
+        }
+    }
+
+    bignum_t mod;
+    barrett_t ctx;
+};
+
+TEST_P(BarrettTest, ReduceMatchesMod) {
+    const size_t words = GetParam();
+    ASSERT_EQ(ctx.k, words);
+
+    for (size_t iter = 0; iter < 20; ++iter) {
+        bignum_t val, expected, actual;
+        random_words(&val, iter == 0 ? 2 * words : 1 + rand() % (2 * words));
+        bn_mod(&val, &mod, &expected, BN_ARRAY_SIZE);
+
+        barrett_reduce(&ctx, &val, &actual);
+        ASSERT_EQ(bn_cmp(&actual, &expected, words * 2), BN_CMP_EQUAL) << "iter = " << iter;
+
+        // Результат на месте аргумента
+        barrett_reduce(&ctx, &val, &val);
+        ASSERT_EQ(bn_cmp(&val, &expected, words * 2), BN_CMP_EQUAL) << "iter = " << iter;
+    }
+}
+
+TEST_P(BarrettTest, MulmodMatchesMod) {
+    const size_t words = GetParam();
+
+    for (size_t iter = 0; iter < 20; ++iter) {
+        bignum_t a_words, b_words, a, b, prod, expected, actual;
+        random_words(&a_words, words);
+        random_words(&b_words, words);
+        bn_mod(&a_words, &mod, &a, BN_ARRAY_SIZE);
+        bn_mod(&b_words, &mod, &b, BN_ARRAY_SIZE);
+
+        bn_karatsuba(&a, &b, &prod, words * 2);
+        bn_mod(&prod, &mod, &expected, words * 2);
+
+        barrett_mulmod(&ctx, &a, &b, &actual);
+        ASSERT_EQ(bn_cmp(&actual, &expected, words * 2), BN_CMP_EQUAL) << "iter = " << iter;
+    }
+}
+
+// Модуль - степень двойки: mu на единицу меньше точного, остаток всё равно верный
+TEST(BarrettPowerOfTwo, Reduce) {
+    bignum_t mod = {0}, val, expected, actual;
+    mod[1] = (BN_DTYPE)1 << 3;
+    barrett_t ctx;
+    barrett_init(&ctx, &mod);
+
+    bn_init(&val, BN_ARRAY_SIZE);
+    val[0] = val[1] = val[2] = val[3] = (BN_DTYPE)BN_MAX_VAL;
+    bn_mod(&val, &mod, &expected, BN_ARRAY_SIZE);
+    barrett_reduce(&ctx, &val, &actual);
+    ASSERT_EQ(bn_cmp(&actual, &expected, 4), BN_CMP_EQUAL);
+}
+
+// Модуль длиннее BN_ARRAY_SIZE / 2: контекста нет (k = 0), оба приведения сводятся к bn_mod
+TEST(BarrettNoContext, FallsBackToMod) {
+    const size_t words = BN_ARRAY_SIZE / 2 + 1;
+    bignum_t mod, a = {0}, b = {0}, prod, expected, actual;
+    bn_init(&mod, BN_ARRAY_SIZE);
+    for (size_t i = 0; i < words; ++i) {
+        mod[i] = (BN_DTYPE)(i * 0x9E3779B9u + 1);
+    }
+    barrett_t ctx;
+    barrett_init(&ctx, &mod);
+    ASSERT_EQ(ctx.k, 0u);
+
+    // Произведение должно поместиться в bignum_t
+    for (size_t i = 0; i < BN_ARRAY_SIZE / 4; ++i) {
+        a[i] = (BN_DTYPE)BN_MAX_VAL - i;
+        b[i] = (BN_DTYPE)(i * 7 + 3);
+    }
+    bn_karatsuba(&a, &b, &prod, BN_ARRAY_SIZE);
+    bn_mod(&prod, &mod, &expected, BN_ARRAY_SIZE);
+
+    memset(actual, 0xA5, sizeof(actual));
+    barrett_mulmod(&ctx, &a, &b, &actual);
+    ASSERT_EQ(bn_cmp(&actual, &expected, BN_ARRAY_SIZE), BN_CMP_EQUAL);
+
+    barrett_reduce(&ctx, &prod, &actual);
+    ASSERT_EQ(bn_cmp(&actual, &expected, BN_ARRAY_SIZE), BN_CMP_EQUAL);
+}
+
+INSTANTIATE_TEST_SUITE_P(Sizes, BarrettTest, testing::Values(1, 2, 3, BN_ARRAY_SIZE / 8, BN_ARRAY_SIZE / 4 + 1, BN_ARRAY_SIZE / 2));
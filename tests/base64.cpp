@@ -25,4 +25,14 @@ TEST(Base64Test, ReadTestError) {
     int size = base64_read(base64_enc, strlen((char*)base64_enc), base64_dec, dec_size);
 
     ASSERT_EQ(size, 0);
-}
\ No newline at end of file
+}
+TEST(Base64Test, ReadTestWithoutPadding) {
+    const uint8_t base64_enc[] = "SGVsbG8h";
+    const uint8_t base64_dec_res[] = "Hello!";
+
+    const size_t dec_size = 16;
+    uint8_t base64_dec[dec_size] = "";
+    base64_read(base64_enc, strlen((char*)base64_enc), base64_dec, dec_size);
+
+    ASSERT_STREQ((char*)base64_dec, (char*)base64_dec_res);
+}
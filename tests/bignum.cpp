@@ -1,5 +1,8 @@
 #include "gtest/gtest.h"
 
+#include <string>
+#include <vector>
+
 extern "C" {
 #include "bignum.h"
 }
@@ -9,11 +12,11 @@ TEST(BignumTest, Fill) {
     const size_t offset1 = 0, offset2 = 0, offset3 = BN_ARRAY_SIZE / 2;
     const size_t count1 = BN_ARRAY_SIZE, count2 = BN_ARRAY_SIZE, count3 = BN_ARRAY_SIZE / 2;
     // BN_DTYPE val1 = 0, val2 = BN_MAX_VAL / 2, val3 = BN_MAX_VAL;
-    const int val1 = 0, val3 = BN_MAX_VAL;
+    const BN_DTYPE val1 = 0, val3 = (BN_DTYPE)BN_MAX_VAL;
 
-    bn_memset(&b1, offset1, val1, count1);
+    bn_memset(&b1, offset1, (int)val1, count1);
     // bn_memset(&b2, offset2, val2, count2);
-    bn_memset(&b3, offset3, val3, count3);
+    bn_memset(&b3, offset3, (int)val3, count3);
 
     for (size_t i = offset1; i < count1; ++i) {
         ASSERT_EQ(b1[i], val1);
@@ -44,9 +47,9 @@ TEST(BignumTest, Init) {
 
 TEST(BignumTest, Assign) {
     bignum_t b1, b2, res;
-    const int val1 = 0, val2 = BN_MAX_VAL;
-    bn_memset(&b1, 0, val1, BN_ARRAY_SIZE);
-    bn_memset(&b2, 0, val2, BN_ARRAY_SIZE);
+    const BN_DTYPE val1 = 0, val2 = (BN_DTYPE)BN_MAX_VAL;
+    bn_memset(&b1, 0, (int)val1, BN_ARRAY_SIZE);
+    bn_memset(&b2, 0, (int)val2, BN_ARRAY_SIZE);
 
     bn_assign(&res, 0, &b1, 0, BN_ARRAY_SIZE / 2);
     bn_assign(&res, BN_ARRAY_SIZE / 2, &b2, 0, BN_ARRAY_SIZE / 2);
@@ -91,9 +94,51 @@ TEST(BignumTest, FromBytes) {
     for (size_t i = 2; i < BN_ARRAY_SIZE; ++i) {
         ASSERT_EQ(b2[i], 0);
     }
+#elif BN_WORD_SIZE == 8
+    ASSERT_EQ(b1[0], 65537);
+    for (size_t i = 1; i < BN_ARRAY_SIZE; ++i) {
+        ASSERT_EQ(b1[i], 0);
+    }
+
+    ASSERT_EQ(b2[0], 0x100000001);
+    for (size_t i = 1; i < BN_ARRAY_SIZE; ++i) {
+        ASSERT_EQ(b2[i], 0);
+    }
 #endif
 }
 
+// Разбиение на буферы по любым границам не меняет число; I2OSP дополняет нулями слева и не обрезает
+TEST(BignumTest, IovAndToBytes) {
+    uint8_t bytes[37];
+    for (size_t i = 0; i < sizeof(bytes); ++i) {
+        bytes[i] = (uint8_t)(i * 29 + 3);
+    }
+    bignum_t whole, parts;
+    bn_from_bytes(&whole, bytes, sizeof(bytes));
+
+    for (size_t a = 0; a <= sizeof(bytes); a += 5) {
+        for (size_t b = a; b <= sizeof(bytes); b += 3) {
+            const struct iovec iov[] = {{bytes, a}, {bytes + a, b - a}, {bytes + b, sizeof(bytes) - b}};
+            bn_from_iov(&parts, iov, 3);
+            for (size_t i = 0; i < BN_ARRAY_SIZE; ++i) {
+                ASSERT_EQ(parts[i], whole[i]) << "a = " << a << ", b = " << b;
+            }
+        }
+    }
+
+    uint8_t out[48];
+    ASSERT_EQ(bn_to_bytes(&whole, out, sizeof(bytes)), 0);
+    ASSERT_TRUE(memcmp(out, bytes, sizeof(bytes)) == 0);
+
+    ASSERT_EQ(bn_to_bytes(&whole, out, sizeof(out)), 0);
+    for (size_t i = 0; i < sizeof(out) - sizeof(bytes); ++i) {
+        ASSERT_EQ(out[i], 0);
+    }
+    ASSERT_TRUE(memcmp(out + sizeof(out) - sizeof(bytes), bytes, sizeof(bytes)) == 0);
+
+    ASSERT_EQ(bn_to_bytes(&whole, out, sizeof(bytes) - 1), -1);
+}
+
 TEST(BignumTest, StringConversions) {
     bignum_t inb1, inb2, outb1, outb2;
 
@@ -114,6 +159,32 @@ TEST(BignumTest, StringConversions) {
     }
 }
 
+// Нулевые разряды в середине, неполный старший разряд, заглавные цифры и точная длина буфера
+TEST(BignumTest, HexCodec) {
+    const size_t digits = BN_WORD_SIZE * 2;
+    std::string hex = "1F";
+    hex += std::string(digits, '0');
+    hex += std::string(digits - 1, '0') + "a";
+
+    bignum_t b;
+    bn_from_string(&b, hex.c_str(), hex.size());
+    ASSERT_EQ(b[0], (BN_DTYPE)0xa);
+    ASSERT_EQ(b[1], (BN_DTYPE)0);
+    ASSERT_EQ(b[2], (BN_DTYPE)0x1f);
+    for (size_t i = 3; i < BN_ARRAY_SIZE; ++i) {
+        ASSERT_EQ(b[i], (BN_DTYPE)0);
+    }
+
+    const std::string expected = std::string(digits - 2, '0') + "1f" + hex.substr(2);
+    std::vector<char> out(expected.size() + 1, 'x');
+    ASSERT_EQ(bn_to_string(&b, out.data(), out.size()), expected.size());
+    ASSERT_STREQ(out.data(), expected.c_str());
+
+    // На '\0' не хватает места - пустая строка
+    ASSERT_EQ(bn_to_string(&b, out.data(), out.size() - 1), expected.size());
+    ASSERT_STREQ(out.data(), "");
+}
+
 TEST(BignumTest, FromInt) {
     bignum_t b1, b2, b3;
     BN_DTYPE_TMP val1, val2, val3;
@@ -237,13 +308,241 @@ TEST(BignumTest, KaratsubaMultiplication) {
     }
 }
 
-// TEST(BignumTest, Division) {
-//     FAIL();
-// }
+// Сравнение со школьным умножением на размерах выше и ниже BN_KARATSUBA_CUTOFF
+TEST(BignumTest, KaratsubaMatchesSchoolbook) {
+    srand(2);
+    for (size_t words = 1; words <= BN_ARRAY_SIZE / 2; words = words * 3 / 2 + 1) {
+        const size_t half = bn_karatsuba_size(words);
+        if (half * 2 > BN_ARRAY_SIZE) {
+            break;
+        }
 
-// TEST(BignumTest, Modulo) {
-//     FAIL();
-// }
+        bignum_t b1 = {0}, b2 = {0}, res, expected = {0};
+        for (size_t i = 0; i < words; ++i) {
+            b1[i] = (BN_DTYPE)rand() * (BN_DTYPE)rand();
+            b2[i] = i % 4 == 0 ? (BN_DTYPE)BN_MAX_VAL : (BN_DTYPE)rand() * (BN_DTYPE)rand();
+        }
+
+        for (size_t i = 0; i < words; ++i) {
+            BN_DTYPE_TMP carry = 0;
+            for (size_t j = 0; j < words; ++j) {
+                carry += (BN_DTYPE_TMP)b1[i] * b2[j] + expected[i + j];
+                expected[i + j] = (BN_DTYPE)carry;
+                carry >>= BN_WORD_SIZE * 8;
+            }
+            expected[i + words] = (BN_DTYPE)carry;
+        }
+
+        bn_karatsuba(&b1, &b2, &res, half * 2);
+        for (size_t i = 0; i < half * 2; ++i) {
+            ASSERT_EQ(res[i], expected[i]) << "words = " << words << ", i = " << i;
+        }
+    }
+}
+
+// Любые размеры, в том числе нечётные, выше и ниже BN_KARATSUBA_CUTOFF;
+// операнды из одних единиц дают максимальные суммы половин
+TEST(BignumTest, MultiplyAnySize) {
+    srand(4);
+    for (size_t words = 1; words <= BN_ARRAY_SIZE / 2; words += words < 40 ? 1 : 7) {
+        for (int pattern = 0; pattern < 2; ++pattern) {
+            bignum_t b1 = {0}, b2 = {0}, res, expected = {0};
+            for (size_t i = 0; i < words; ++i) {
+                b1[i] = pattern ? (BN_DTYPE)BN_MAX_VAL : (BN_DTYPE)rand() * (BN_DTYPE)rand();
+                b2[i] = pattern || i % 5 == 0 ? (BN_DTYPE)BN_MAX_VAL : (BN_DTYPE)rand() * (BN_DTYPE)rand();
+            }
+
+            for (size_t i = 0; i < words; ++i) {
+                BN_DTYPE_TMP carry = 0;
+                for (size_t j = 0; j < words; ++j) {
+                    carry += (BN_DTYPE_TMP)b1[i] * b2[j] + expected[i + j];
+                    expected[i + j] = (BN_DTYPE)carry;
+                    carry >>= BN_WORD_SIZE * 8;
+                }
+                expected[i + words] = (BN_DTYPE)carry;
+            }
+
+            bn_karatsuba(&b1, &b2, &res, words * 2);
+            for (size_t i = 0; i < words * 2; ++i) {
+                ASSERT_EQ(res[i], expected[i]) << "words = " << words << ", pattern = " << pattern << ", i = " << i;
+            }
+
+            // Результат на месте операнда
+            bn_karatsuba(&b1, &b2, &b1, words * 2);
+            for (size_t i = 0; i < words * 2; ++i) {
+                ASSERT_EQ(b1[i], expected[i]) << "words = " << words << ", pattern = " << pattern << ", i = " << i;
+            }
+        }
+    }
+}
+
+// Рабочая область вызывающего: умножение не выходит за bn_karatsuba_scratch_size
+// и совпадает с вариантом на области потока; все единицы дают переносы на каждом уровне
+TEST(BignumTest, KaratsubaCallerScratch) {
+    const size_t size = BN_ARRAY_SIZE;
+    const size_t scratch_size = bn_karatsuba_scratch_size(size);
+    ASSERT_LE(scratch_size, (size_t)BN_SCRATCH_MAX_SIZE);
+
+    std::vector<BN_DTYPE> scratch(scratch_size + 1);
+    scratch[scratch_size] = 0x5a;
+
+    // (B^k - 1)^2 = B^2k - 2 * B^k + 1
+    bignum_t b = {0}, res, expected = {0};
+    for (size_t i = 0; i < size / 2; ++i) {
+        b[i] = (BN_DTYPE)BN_MAX_VAL;
+        expected[size / 2 + i] = (BN_DTYPE)BN_MAX_VAL;
+    }
+    expected[0] = 1;
+    expected[size / 2] = (BN_DTYPE)BN_MAX_VAL - 1;
+
+    bn_karatsuba(&b, &b, &res, size);
+    for (size_t i = 0; i < size; ++i) {
+        ASSERT_EQ(res[i], expected[i]) << "i = " << i;
+    }
+
+    bn_karatsuba_ws(&b, &b, &res, size, scratch.data());
+    for (size_t i = 0; i < size; ++i) {
+        ASSERT_EQ(res[i], expected[i]) << "i = " << i;
+    }
+    ASSERT_EQ(scratch[scratch_size], (BN_DTYPE)0x5a);
+}
+
+// Операции по значащим длинам на несимметричных операндах сверяются с полноразмерными
+TEST(BignumTest, UsedSizeOps) {
+    const size_t size = BN_ARRAY_SIZE / 2;
+    srand(4);
+    for (size_t len2 = 0; len2 <= size / 2; len2 = len2 * 2 + 1) {
+        const size_t len1 = size / 2;
+        bignum_t a = {0}, b = {0}, res, expected;
+        for (size_t i = 0; i < len1; ++i) {
+            a[i] = i % 5 == 0 ? (BN_DTYPE)BN_MAX_VAL : (BN_DTYPE)rand() * (BN_DTYPE)rand();
+        }
+        for (size_t i = 0; i < len2; ++i) {
+            b[i] = (BN_DTYPE)rand() * (BN_DTYPE)rand() | 1;
+        }
+        ASSERT_EQ(bn_used_size(&a, BN_ARRAY_SIZE), len1);
+        ASSERT_EQ(bn_used_size(&b, BN_ARRAY_SIZE), len2);
+        ASSERT_EQ(bn_cmp_used(&a, len1, &b, len2), bn_cmp(&a, &b, BN_ARRAY_SIZE));
+        ASSERT_EQ(bn_cmp_used(&b, len2, &a, len1), bn_cmp(&b, &a, BN_ARRAY_SIZE));
+
+        bn_karatsuba(&a, &b, &expected, size * 2);
+        bn_init(&res, BN_ARRAY_SIZE);
+        const size_t prod_len = bn_mul_used(&a, len1, &b, len2, &res);
+        ASSERT_EQ(prod_len, bn_used_size(&expected, size * 2));
+        for (size_t i = 0; i < size * 2; ++i) {
+            ASSERT_EQ(res[i], expected[i]) << "len2 = " << len2 << ", i = " << i;
+        }
+
+        bn_add(&a, &b, &expected, size);
+        bn_init(&res, BN_ARRAY_SIZE);
+        const size_t sum_len = bn_add_used(&b, len2, &a, len1, &res);
+        ASSERT_EQ(sum_len, bn_used_size(&expected, size));
+        for (size_t i = 0; i < size; ++i) {
+            ASSERT_EQ(res[i], expected[i]) << "len2 = " << len2 << ", i = " << i;
+        }
+
+        ASSERT_EQ(bn_sub_used(&res, sum_len, &b, len2, &res), len1);
+        for (size_t i = 0; i < size; ++i) {
+            ASSERT_EQ(res[i], a[i]) << "len2 = " << len2 << ", i = " << i;
+        }
+    }
+}
+
+// Сдвиг на k бит сверяется с k сдвигами на один бит, включая сдвиг на месте
+TEST(BignumTest, Shifts) {
+    const size_t size = BN_ARRAY_SIZE / 2;
+    const size_t word_bits = BN_WORD_SIZE * 8;
+    const size_t counts[] = {0, 1, word_bits - 1, word_bits, word_bits + 3, word_bits * 5 + 7, size * word_bits - 1, size * word_bits};
+    srand(5);
+
+    bignum_t src = {0};
+    for (size_t i = 0; i < size; ++i) {
+        src[i] = (BN_DTYPE)rand() * (BN_DTYPE)rand();
+    }
+
+    for (size_t bits : counts) {
+        bignum_t left, right, left_step, right_step;
+        bn_assign(&left_step, 0, &src, 0, size);
+        bn_assign(&right_step, 0, &src, 0, size);
+        for (size_t k = 0; k < bits; ++k) {
+            bn_lshift(&left_step, &left_step, 1, size);
+            bn_rshift(&right_step, &right_step, 1, size);
+        }
+
+        bn_lshift(&src, &left, bits, size);
+        bn_rshift(&src, &right, bits, size);
+        for (size_t i = 0; i < size; ++i) {
+            ASSERT_EQ(left[i], left_step[i]) << "bits = " << bits << ", i = " << i;
+            ASSERT_EQ(right[i], right_step[i]) << "bits = " << bits << ", i = " << i;
+        }
+
+        // Сдвиг влево и обратно теряет только вытесненные старшие биты
+        bn_rshift(&left, &left, bits, size);
+        bn_lshift(&right, &right, bits, size);
+        for (size_t i = 0; i < size; ++i) {
+            const size_t lost = size * word_bits - bits;
+            const BN_DTYPE mask_left = i * word_bits >= lost ? 0 : (i + 1) * word_bits <= lost ? (BN_DTYPE)BN_MAX_VAL : (BN_DTYPE)(((BN_DTYPE)1 << (lost % word_bits)) - 1);
+            const BN_DTYPE mask_right = (i + 1) * word_bits <= bits ? 0 : i * word_bits >= bits ? (BN_DTYPE)BN_MAX_VAL : (BN_DTYPE)~(((BN_DTYPE)1 << (bits % word_bits)) - 1);
+            ASSERT_EQ(left[i], src[i] & mask_left) << "bits = " << bits << ", i = " << i;
+            ASSERT_EQ(right[i], src[i] & mask_right) << "bits = " << bits << ", i = " << i;
+        }
+    }
+}
+
+TEST(BignumTest, Division) {
+    const size_t size = 16;
+    bignum_t num = {0}, den = {0}, q, r, prod, sum;
+
+    // 100 / 7 = 14, остаток 2
+    bn_from_int(&num, 100, size);
+    bn_from_int(&den, 7, size);
+    bn_divmod(&num, &den, &q, &r, size);
+    ASSERT_EQ(q[0], 14);
+    ASSERT_EQ(r[0], 2);
+    for (size_t i = 1; i < size; ++i) {
+        ASSERT_EQ(q[i], 0);
+        ASSERT_EQ(r[i], 0);
+    }
+
+    // Делимое меньше делителя
+    bn_divmod(&den, &num, &q, &r, size);
+    ASSERT_TRUE(bn_is_zero(&q, size));
+    ASSERT_EQ(r[0], 7);
+
+    // q * den + r == num, r < den для делителей разной длины, включая разряды BN_MAX_VAL
+    srand(1);
+    for (size_t iter = 0; iter < 1000; ++iter) {
+        const size_t num_size = 1 + iter % (size / 2);
+        const size_t den_size = 1 + (iter / 7) % num_size;
+
+        bn_init(&num, size);
+        bn_init(&den, size);
+        for (size_t i = 0; i < num_size; ++i) {
+            num[i] = iter % 3 == 0 ? (BN_DTYPE)BN_MAX_VAL : (BN_DTYPE)rand() * (BN_DTYPE)rand();
+        }
+        for (size_t i = 0; i < den_size; ++i) {
+            den[i] = iter % 5 == 0 ? (BN_DTYPE)BN_MAX_VAL - i : (BN_DTYPE)rand() * (BN_DTYPE)rand();
+        }
+        if (bn_is_zero(&den, size)) {
+            den[0] = 1;
+        }
+
+        bn_divmod(&num, &den, &q, &r, size);
+        ASSERT_EQ(bn_cmp(&r, &den, size), BN_CMP_SMALLER);
+
+        bn_karatsuba(&q, &den, &prod, size);
+        bn_add(&prod, &r, &sum, size);
+        for (size_t i = 0; i < size; ++i) {
+            ASSERT_EQ(sum[i], num[i]);
+        }
+
+        bignum_t q2, r2;
+        bn_div(&num, &den, &q2, size);
+        bn_mod(&num, &den, &r2, size);
+        ASSERT_EQ(bn_cmp(&q, &q2, size), BN_CMP_EQUAL);
+        ASSERT_EQ(bn_cmp(&r, &r2, size), BN_CMP_EQUAL);
+    }
+}
 
 // TEST(BignumTest, BitwiseOr) {
 //     FAIL();
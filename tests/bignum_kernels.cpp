@@ -0,0 +1,66 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+extern "C" {
+#include "bignum_kernels.h"
+}
+
+// Ядра ADX сверяются с переносимыми на случайных разрядах и на цепочках максимальных значений
+class BignumKernelsTest : public testing::TestWithParam<size_t> {
+protected:
+    void SetUp() override {
+        adx = bn_kernels_adx();
+        if (adx == NULL) {
+            GTEST_SKIP() << "ADX/BMI2 is not available";
+        }
+
+        const size_t n = GetParam();
+        srand(n);
+        a.resize(n);
+        b.resize(n);
+        res.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            a[i] = i % 3 == 0 ? (BN_DTYPE)BN_MAX_VAL : (BN_DTYPE)rand() * (BN_DTYPE)rand();
+            b[i] = i % 4 == 0 ? (BN_DTYPE)BN_MAX_VAL : (BN_DTYPE)rand() * (BN_DTYPE)rand();
+            res[i] = i % 2 == 0 ? (BN_DTYPE)BN_MAX_VAL : (BN_DTYPE)rand();
+        }
+    }
+
+    const bn_kernels_t *adx = NULL;
+    const bn_kernels_t *portable = bn_kernels_portable();
+    std::vector<BN_DTYPE> a, b, res;
+};
+
+TEST_P(BignumKernelsTest, AddSub) {
+    const size_t n = GetParam();
+    std::vector<BN_DTYPE> expected(n), actual(n);
+
+    ASSERT_EQ(adx->add_n(actual.data(), a.data(), b.data(), n), portable->add_n(expected.data(), a.data(), b.data(), n));
+    ASSERT_EQ(actual, expected);
+
+    ASSERT_EQ(adx->sub_n(actual.data(), a.data(), b.data(), n), portable->sub_n(expected.data(), a.data(), b.data(), n));
+    ASSERT_EQ(actual, expected);
+
+    // Результат на месте операнда
+    actual = a;
+    ASSERT_EQ(adx->add_n(actual.data(), actual.data(), b.data(), n), portable->add_n(expected.data(), a.data(), b.data(), n));
+    ASSERT_EQ(actual, expected);
+}
+
+TEST_P(BignumKernelsTest, MulAccumulate) {
+    const size_t n = GetParam();
+    const BN_DTYPE multipliers[] = {0, 1, (BN_DTYPE)BN_MAX_VAL, (BN_DTYPE)(b[0] ^ 0x5a5a)};
+
+    for (BN_DTYPE m : multipliers) {
+        std::vector<BN_DTYPE> expected = res, actual = res;
+        ASSERT_EQ(adx->addmul_1(actual.data(), a.data(), n, m), portable->addmul_1(expected.data(), a.data(), n, m));
+        ASSERT_EQ(actual, expected);
+
+        expected = res, actual = res;
+        ASSERT_EQ(adx->submul_1(actual.data(), a.data(), n, m), portable->submul_1(expected.data(), a.data(), n, m));
+        ASSERT_EQ(actual, expected);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Sizes, BignumKernelsTest, testing::Values(1, 3, 4, 7, 32, 65));
@@ -2,4 +2,285 @@
 
 extern "C" {
 #include "montgomery.h"
+#include <string.h>
 }
+
+class MontgomeryTest : public testing::TestWithParam<size_t> {
+protected:
+    void SetUp() override {
+        const size_t words = GetParam();
+
+        srand(words);
+        bn_init(&mod, BN_ARRAY_SIZE);
+        for (size_t i = 0; i < words; ++i) {
+            mod[i] = (BN_DTYPE)rand() * (BN_DTYPE)rand();
+        }
+        mod[0] |= 1;
+        mod[words - 1] |= (BN_DTYPE)1 << (BN_WORD_SIZE * 8 - 1);
+
+        montg_init(&md, &mod);
+        size = md.shift * 2;
+    }
+
+    // Случайное число меньше модуля
+    void random_below_mod(bignum_t *val) {
+        bn_init(val, BN_ARRAY_SIZE);
+        for (size_t i = 0; i < GetParam(); ++i) {
+            (*val)[i] = (BN_DTYPE)rand() * (BN_DTYPE)rand();
+        }
+        bn_mod(val, &mod, val, size);
+    }
+
+    bignum_t mod;
+    montg_t md;
+    size_t size;
+};
+
+TEST_P(MontgomeryTest, MulMatchesPlainProduct) {
+    for (size_t iter = 0; iter < 20; ++iter) {
+        bignum_t a, b, a_montg, b_montg, res_montg, res, prod, expected;
+        random_below_mod(&a);
+        random_below_mod(&b);
+
+        montg_transform(&md, &a, &a_montg);
+        montg_transform(&md, &b, &b_montg);
+        montg_mul(&md, &a_montg, &b_montg, &res_montg);
+        montg_revert(&md, &res_montg, &res);
+
+        bn_karatsuba(&a, &b, &prod, size);
+        bn_mod(&prod, &mod, &expected, size);
+
+        ASSERT_EQ(bn_cmp(&res, &expected, md.shift), BN_CMP_EQUAL);
+    }
+}
+
+TEST_P(MontgomeryTest, SqrMatchesMul) {
+    for (size_t iter = 0; iter < 20; ++iter) {
+        bignum_t a, a_montg, sqr = {0}, mul = {0};
+        random_below_mod(&a);
+        montg_transform(&md, &a, &a_montg);
+
+        montg_mul(&md, &a_montg, &a_montg, &mul);
+        montg_sqr(&md, &a_montg, &sqr);
+
+        ASSERT_EQ(bn_cmp(&sqr, &mul, size), BN_CMP_EQUAL);
+    }
+}
+
+// Константы домена сверяются с делением: n * n0 = -1 mod B, R mod n и R^2 mod n
+TEST_P(MontgomeryTest, InitConstants) {
+    ASSERT_EQ((BN_DTYPE)(mod[0] * md.n0), (BN_DTYPE)BN_MAX_VAL);
+
+    bignum_t r = {0}, expected;
+    r[md.shift] = 1;
+    bn_mod(&r, &mod, &expected, size);
+    ASSERT_EQ(bn_cmp(&md.r, &expected, size), BN_CMP_EQUAL);
+
+    bn_karatsuba(&expected, &expected, &r, size);
+    bn_mod(&r, &mod, &expected, size);
+    ASSERT_EQ(bn_cmp(&md.r2, &expected, size), BN_CMP_EQUAL);
+}
+
+// Перевод в домен и обратно даёт val mod n для любого val < R, в том числе больше модуля
+TEST_P(MontgomeryTest, TransformBelowR) {
+    bignum_t val = {0}, val_montg, res, expected;
+    for (size_t i = 0; i < md.shift; ++i) {
+        val[i] = (BN_DTYPE)BN_MAX_VAL;
+    }
+
+    montg_transform(&md, &val, &val_montg);
+    montg_revert(&md, &val_montg, &res);
+    bn_mod(&val, &mod, &expected, size);
+
+    ASSERT_EQ(bn_cmp(&val_montg, &mod, size), BN_CMP_SMALLER);
+    ASSERT_EQ(bn_cmp(&res, &expected, md.shift), BN_CMP_EQUAL);
+}
+
+// Окно против двоичного метода на показателях разной длины, в том числе на границах ширины окна
+TEST_P(MontgomeryTest, PowWindowMatchesBinary) {
+    const size_t lengths[] = {0, 1, 2, 5, 23, 24, 80, 240, 672, (size_t)md.shift * BN_WORD_SIZE * 8};
+    for (size_t bits : lengths) {
+        bignum_t a, a_montg, exp = {0}, expected = {0}, actual = {0};
+        random_below_mod(&a);
+        montg_transform(&md, &a, &a_montg);
+
+        bits = MIN(bits, (size_t)md.shift * BN_WORD_SIZE * 8);
+        for (size_t i = 0; i < bits; ++i) {
+            if (i + 1 == bits || rand() % 3 != 0) {
+                exp[i / (BN_WORD_SIZE * 8)] |= (BN_DTYPE)1 << (i % (BN_WORD_SIZE * 8));
+            }
+        }
+
+        montg_pow(&md, &a_montg, &exp, &actual);
+        if (bits == 0) {
+            // a^0 = 1, в домене - R mod n
+            ASSERT_EQ(bn_cmp(&actual, &md.r, size), BN_CMP_EQUAL);
+            continue;
+        }
+        montg_pow_binary(&md, &a_montg, &exp, &expected);
+        ASSERT_EQ(bn_cmp(&actual, &expected, size), BN_CMP_EQUAL) << "bits = " << bits;
+    }
+}
+
+// Короткий показатель против общего пути: перевод, двоичный метод, обратный перевод
+TEST_P(MontgomeryTest, PowSmallMatchesPow) {
+    const uint32_t exps[] = {1, 2, 3, 4, 17, 65537, 0xFFFFFFFF};
+    for (uint32_t e : exps) {
+        bignum_t a, a_montg, exp, expected_montg = {0}, expected, actual = {0};
+        random_below_mod(&a);
+        bn_from_int(&exp, e, BN_ARRAY_SIZE);
+
+        montg_transform(&md, &a, &a_montg);
+        montg_pow_binary(&md, &a_montg, &exp, &expected_montg);
+        montg_revert(&md, &expected_montg, &expected);
+
+        montg_pow_small(&md, &a, e, &actual);
+        ASSERT_EQ(bn_cmp(&actual, &expected, size), BN_CMP_EQUAL) << "exp = " << e;
+    }
+
+    // Основание не меньше модуля приводится
+    bignum_t a = {0}, a_mod, expected, actual;
+    for (size_t i = 0; i < md.shift; ++i) {
+        a[i] = (BN_DTYPE)BN_MAX_VAL;
+    }
+    bn_mod(&a, &mod, &a_mod, size);
+    montg_pow_small(&md, &a_mod, 65537, &expected);
+    montg_pow_small(&md, &a, 65537, &actual);
+    ASSERT_EQ(bn_cmp(&actual, &expected, size), BN_CMP_EQUAL);
+}
+
+// Движки должны давать одинаковые результаты; без IFMA проверяется только скалярный
+TEST_P(MontgomeryTest, EnginesAgree) {
+    montg_t md_ifma = md;
+    ASSERT_EQ(montg_set_engine(&md, MONTG_ENGINE_SCALAR), 0);
+    if (montg_set_engine(&md_ifma, MONTG_ENGINE_IFMA) != 0) {
+        GTEST_SKIP() << "IFMA is not available";
+    }
+    // -n^-1 mod 2^52
+    const uint64_t ifma_mask = ((uint64_t)1 << 52) - 1;
+    ASSERT_EQ((md_ifma.ifma_n0 * (uint64_t)mod[0]) & ifma_mask, ifma_mask);
+
+    for (size_t iter = 0; iter < 5; ++iter) {
+        bignum_t a, b, exp, a_montg, b_montg, expected = {0}, actual = {0};
+        random_below_mod(&a);
+        random_below_mod(&b);
+        random_below_mod(&exp);
+        montg_transform(&md, &a, &a_montg);
+        montg_transform(&md, &b, &b_montg);
+
+        montg_mul(&md, &a_montg, &b_montg, &expected);
+        montg_mul(&md_ifma, &a_montg, &b_montg, &actual);
+        ASSERT_EQ(bn_cmp(&actual, &expected, size), BN_CMP_EQUAL);
+
+        montg_sqr(&md, &a_montg, &expected);
+        montg_sqr(&md_ifma, &a_montg, &actual);
+        ASSERT_EQ(bn_cmp(&actual, &expected, size), BN_CMP_EQUAL);
+
+        montg_pow(&md, &a_montg, &exp, &expected);
+        montg_pow(&md_ifma, &a_montg, &exp, &actual);
+        ASSERT_EQ(bn_cmp(&actual, &expected, size), BN_CMP_EQUAL);
+
+        montg_pow_small(&md, &a, 65537, &expected);
+        montg_pow_small(&md_ifma, &a, 65537, &actual);
+        ASSERT_EQ(bn_cmp(&actual, &expected, size), BN_CMP_EQUAL);
+    }
+}
+
+// Многобуферное возведение в степень: каждое число совпадает со скалярным путём,
+// в том числе в неполной последней группе и при основании не меньше модуля
+TEST_P(MontgomeryTest, PowManyMatchesScalar) {
+    const size_t count = MONTG_MB_LANES * 2 - 1;
+    montg_t md_scalar = md, md_lanes = md;
+    md_scalar.mb_use = 0;
+    md_lanes.mb_use = md.mb_digits != 0;
+
+    const size_t lengths[] = {1, 17, 80, (size_t)md.shift * BN_WORD_SIZE * 8};
+    for (size_t bits : lengths) {
+        bignum_t vals[count], expected[count], actual[count], exp = {0};
+        for (size_t i = 0; i < count; ++i) {
+            random_below_mod(&vals[i]);
+        }
+        bn_init(&vals[2], BN_ARRAY_SIZE);
+        for (size_t i = 0; i < md.shift; ++i) {
+            vals[2][i] = (BN_DTYPE)BN_MAX_VAL;
+        }
+        bn_init(&vals[3], BN_ARRAY_SIZE);
+
+        bits = MIN(bits, (size_t)md.shift * BN_WORD_SIZE * 8);
+        for (size_t i = 0; i < bits; ++i) {
+            if (i + 1 == bits || rand() % 3 != 0) {
+                exp[i / (BN_WORD_SIZE * 8)] |= (BN_DTYPE)1 << (i % (BN_WORD_SIZE * 8));
+            }
+        }
+
+        montg_pow_many(&md_scalar, vals, &exp, expected, count);
+        montg_pow_many(&md_lanes, vals, &exp, actual, count);
+        for (size_t i = 0; i < count; ++i) {
+            bignum_t val_montg, res_montg = {0}, res;
+            montg_transform(&md, &vals[i], &val_montg);
+            montg_pow(&md, &val_montg, &exp, &res_montg);
+            montg_revert(&md, &res_montg, &res);
+
+            ASSERT_EQ(bn_cmp(&expected[i], &res, size), BN_CMP_EQUAL) << "bits = " << bits << ", i = " << i;
+            ASSERT_EQ(bn_cmp(&actual[i], &res, size), BN_CMP_EQUAL) << "bits = " << bits << ", i = " << i;
+        }
+    }
+}
+
+// Основание не меньше R (разряды выше shift) приводится по n целиком, а не обрезается до R
+TEST_P(MontgomeryTest, WideBaseReducedByMod) {
+    const size_t count = MONTG_MB_LANES;
+    bignum_t vals[count], reduced[count], expected[count], actual[count], exp;
+    for (size_t i = 0; i < count; ++i) {
+        bn_init(&vals[i], BN_ARRAY_SIZE);
+        for (size_t j = 0; j < size; ++j) {
+            vals[i][j] = (BN_DTYPE)rand() * (BN_DTYPE)rand();
+        }
+        vals[i][size - 1] |= 1;
+        bn_mod(&vals[i], &mod, &reduced[i], BN_ARRAY_SIZE);
+    }
+
+    montg_pow_small(&md, &reduced[0], 65537, &expected[0]);
+    montg_pow_small(&md, &vals[0], 65537, &actual[0]);
+    ASSERT_EQ(bn_cmp(&actual[0], &expected[0], size), BN_CMP_EQUAL);
+
+    bn_from_int(&exp, 65537, BN_ARRAY_SIZE);
+    montg_t md_scalar = md, md_lanes = md;
+    md_scalar.mb_use = 0;
+    md_lanes.mb_use = md.mb_digits != 0;
+    for (const montg_t *domain : {&md_scalar, &md_lanes}) {
+        montg_pow_many(domain, reduced, &exp, expected, count);
+        montg_pow_many(domain, vals, &exp, actual, count);
+        for (size_t i = 0; i < count; ++i) {
+            ASSERT_EQ(bn_cmp(&actual[i], &expected[i], size), BN_CMP_EQUAL) << "mb_use = " << (int)domain->mb_use << ", i = " << i;
+        }
+    }
+}
+
+// Удвоенный домен не помещается в bignum_t: md обнуляется, возведения в степень ничего не пишут
+TEST(MontgomeryOversized, LeavesDomainEmpty) {
+    bignum_t mod = {0}, val = {0}, exp = {0}, res, untouched;
+    mod[0] = 1;
+    mod[BN_ARRAY_SIZE / 2] = 1;
+    val[0] = 2;
+    exp[0] = 3;
+
+    montg_t md;
+    memset(&md, 0xA5, sizeof(md));
+    montg_init(&md, &mod);
+    ASSERT_EQ(md.shift, 0u);
+    ASSERT_EQ(md.mb_use, 0);
+
+    memset(res, 0xA5, sizeof(res));
+    memset(untouched, 0xA5, sizeof(untouched));
+    montg_pow(&md, &val, &exp, &res);
+    montg_pow_small(&md, &val, 65537, &res);
+    montg_pow_many(&md, &val, &exp, &res, 1);
+    ASSERT_EQ(memcmp(res, untouched, sizeof(res)), 0);
+
+    memset(&md, 0xA5, sizeof(md));
+    montg_init(&md, NULL);
+    ASSERT_EQ(md.shift, 0u);
+}
+
+INSTANTIATE_TEST_SUITE_P(Sizes, MontgomeryTest, testing::Values(1, 3, BN_ARRAY_SIZE / 8, BN_ARRAY_SIZE / 4, BN_ARRAY_SIZE / 2 - 1, BN_ARRAY_SIZE / 2));
@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+#include <stdint.h>
+
+extern "C" {
+#include "rsa_pool.h"
+#include <string.h>
+}
+
+#include "keys.h"
+
+// Смешанный пакет заданий на пуле из разного числа потоков против последовательных вызовов *_buf
+class RsaPoolTest : public testing::TestWithParam<size_t> {
+protected:
+    static constexpr size_t count = 24;
+
+    void SetUp() override {
+        const test_key_t &key = test_keys[1];
+        import_pub_key(&pub_key, key.pub_data);
+        import_pvt_key(&pvt_key, key.pvt_data);
+        montg_init(&montg_domain_n, &pub_key.mod);
+        montg_init(&montg_domain_p, &pvt_key.p);
+        montg_init(&montg_domain_q, &pvt_key.q);
+        keys = {&pub_key, &pvt_key, &montg_domain_n, &montg_domain_p, &montg_domain_q};
+
+        msg_len = key.bits / 8 - 1;
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t j = 0; j < msg_len; ++j) {
+                msgs[i][j] = (char)(i * 31 + j * 7 + 1);
+            }
+            encrypt_buf(&pub_key, &montg_domain_n, msgs[i], msg_len, encs[i], sizeof(encs[i]));
+            sign_buf(&pvt_key, &montg_domain_n, msgs[i], msg_len, sigs[i], sizeof(sigs[i]));
+        }
+    }
+
+    rsa_pub_key_t pub_key;
+    rsa_pvt_key_t pvt_key;
+    montg_t montg_domain_n, montg_domain_p, montg_domain_q;
+    rsa_keyset_t keys;
+    size_t msg_len;
+    char msgs[count][BN_MSG_LEN + 1] = {};
+    char encs[count][BN_BYTE_SIZE * 2 + 1] = {}, sigs[count][BN_BYTE_SIZE * 2 + 1] = {};
+    char outs[count][BN_BYTE_SIZE * 2 + 1] = {};
+};
+
+TEST_P(RsaPoolTest, MixedJobsMatchSequential) {
+    rsa_job_t jobs[count];
+    for (size_t i = 0; i < count; ++i) {
+        switch (i % 4) {
+            case 0: jobs[i] = {RSA_JOB_ENCRYPT, &keys, msgs[i], msg_len, outs[i], sizeof(outs[i])}; break;
+            case 1: jobs[i] = {RSA_JOB_DECRYPT, &keys, encs[i], strlen(encs[i]), outs[i], sizeof(outs[i])}; break;
+            case 2: jobs[i] = {RSA_JOB_SIGN, &keys, msgs[i], msg_len, outs[i], sizeof(outs[i])}; break;
+            case 3: jobs[i] = {RSA_JOB_VERIFY, &keys, sigs[i], strlen(sigs[i]), outs[i], sizeof(outs[i])}; break;
+        }
+    }
+
+    rsa_pool_t pool;
+    ASSERT_EQ(rsa_pool_init(&pool, GetParam()), 0);
+    // Два пакета подряд: потоки и очереди переиспользуются
+    for (size_t round = 0; round < 2; ++round) {
+        memset(outs, 0, sizeof(outs));
+        rsa_pool_run(&pool, jobs, count);
+
+        for (size_t i = 0; i < count; ++i) {
+            switch (i % 4) {
+                case 0: ASSERT_STREQ(outs[i], encs[i]) << "i = " << i; break;
+                case 2: ASSERT_STREQ(outs[i], sigs[i]) << "i = " << i; break;
+                default: ASSERT_TRUE(memcmp(outs[i], msgs[i], msg_len) == 0) << "i = " << i; break;
+            }
+        }
+    }
+    rsa_pool_destroy(&pool);
+}
+
+INSTANTIATE_TEST_SUITE_P(Threads, RsaPoolTest, testing::Values(1, 2, 3, 8));
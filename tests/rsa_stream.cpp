@@ -0,0 +1,133 @@
+#include "gtest/gtest.h"
+#include <stdint.h>
+#include <vector>
+
+extern "C" {
+#include "rsa_stream.h"
+#include <string.h>
+}
+
+#include "keys.h"
+
+// Зашифрование и расшифрование потоком при разной длине данных и порций update;
+// параметр - асинхронный режим
+class RsaStreamTest : public testing::TestWithParam<int> {
+protected:
+    void SetUp() override {
+        const test_key_t &key = test_keys[1];
+        import_pub_key(&pub_key, key.pub_data);
+        import_pvt_key(&pvt_key, key.pvt_data);
+        montg_init(&montg_domain_n, &pub_key.mod);
+        montg_init(&montg_domain_p, &pvt_key.p);
+        montg_init(&montg_domain_q, &pvt_key.q);
+    }
+
+    // Прогоняет data через поток порциями по chunk байт
+    std::vector<char> run(rsa_stream_t *stream, const std::vector<char> &data, size_t chunk, int *status) {
+        std::vector<char> out;
+        for (size_t pos = 0; pos < data.size(); pos += chunk) {
+            const size_t len = MIN(chunk, data.size() - pos);
+            const size_t at = out.size();
+            out.resize(at + rsa_stream_out_size(stream, len));
+            out.resize(at + rsa_stream_update(stream, data.data() + pos, len, out.data() + at));
+        }
+
+        size_t len = 0;
+        const size_t at = out.size();
+        out.resize(at + rsa_stream_out_size(stream, 0));
+        *status = rsa_stream_final(stream, out.data() + at, &len);
+        out.resize(at + len);
+        return out;
+    }
+
+    std::vector<char> encrypt(const std::vector<char> &data, size_t chunk) {
+        int status = -1;
+        EXPECT_EQ(rsa_stream_encrypt_init(&stream, &pub_key, &montg_domain_n, GetParam()), 0);
+        std::vector<char> out = run(&stream, data, chunk, &status);
+        EXPECT_EQ(status, 0);
+        return out;
+    }
+
+    std::vector<char> decrypt(const std::vector<char> &data, size_t chunk, int *status) {
+        EXPECT_EQ(rsa_stream_decrypt_init(&stream, &pvt_key, &montg_domain_n, &montg_domain_p, &montg_domain_q, GetParam()), 0);
+        return run(&stream, data, chunk, status);
+    }
+
+    rsa_pub_key_t pub_key;
+    rsa_pvt_key_t pvt_key;
+    montg_t montg_domain_n, montg_domain_p, montg_domain_q;
+    rsa_stream_t stream;
+};
+
+TEST_P(RsaStreamTest, RoundTrip) {
+    const size_t block = (test_keys[1].bits - 1) / 8;
+    const size_t lens[] = {0, 1, block - 1, block, block + 1, block * RSA_STREAM_SLOT_BLOCKS, block * RSA_STREAM_SLOT_BLOCKS * 3 + 5};
+    const size_t chunks[] = {1, 97, block, 1 << 20};
+
+    for (size_t len : lens) {
+        std::vector<char> data(len);
+        for (size_t i = 0; i < len; ++i) {
+            data[i] = (char)(i * 31 + 7);
+        }
+
+        for (size_t chunk : chunks) {
+            if (chunk == 1 && len > block * 2) {
+                continue;
+            }
+            const std::vector<char> enc = encrypt(data, chunk);
+            ASSERT_EQ(enc.size() % stream.out_block, 0u);
+            ASSERT_EQ(enc.size() / stream.out_block, len / block + 1) << "len = " << len;
+
+            int status = -1;
+            const std::vector<char> dec = decrypt(enc, chunk, &status);
+            ASSERT_EQ(status, 0) << "len = " << len << ", chunk = " << chunk;
+            ASSERT_EQ(dec, data) << "len = " << len << ", chunk = " << chunk;
+        }
+    }
+}
+
+// Полный блок шифротекста совпадает с encrypt_buf того же блока, дополненным нулями слева
+TEST_P(RsaStreamTest, BlocksMatchBuf) {
+    const size_t block = (test_keys[1].bits - 1) / 8;
+    std::vector<char> data(block * 2);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = (char)(i * 13 + 1);
+    }
+    const std::vector<char> enc = encrypt(data, data.size());
+    const size_t width = stream.out_block;
+
+    for (size_t b = 0; b < 2; ++b) {
+        char expected[BN_BYTE_SIZE * 2 + 1] = {};
+        encrypt_buf(&pub_key, &montg_domain_n, data.data() + b * block, block, expected, sizeof(expected));
+        const size_t len = strlen(expected);
+        ASSERT_LE(len, width);
+        ASSERT_EQ(std::string(enc.data() + b * width, width), std::string(width - len, '0') + expected);
+    }
+}
+
+TEST_P(RsaStreamTest, RejectsMalformed) {
+    std::vector<char> data(100, 'x');
+    std::vector<char> enc = encrypt(data, data.size());
+    int status = 0;
+
+    // Обрезанный шифротекст
+    std::vector<char> cut(enc.begin(), enc.end() - 1);
+    decrypt(cut, cut.size(), &status);
+    ASSERT_EQ(status, -1);
+
+    // Пустой шифротекст
+    decrypt({}, 1, &status);
+    ASSERT_EQ(status, -1);
+
+    // Блок без метки дополнения: зашифрован encrypt_buf напрямую
+    const size_t block = (test_keys[1].bits - 1) / 8;
+    std::vector<char> plain(block, 'y');
+    char hex[BN_BYTE_SIZE * 2 + 1] = {};
+    encrypt_buf(&pub_key, &montg_domain_n, plain.data(), plain.size(), hex, sizeof(hex));
+    std::vector<char> bad(stream.in_block - strlen(hex), '0');
+    bad.insert(bad.end(), hex, hex + strlen(hex));
+    decrypt(bad, bad.size(), &status);
+    ASSERT_EQ(status, -1);
+}
+
+INSTANTIATE_TEST_SUITE_P(Async, RsaStreamTest, testing::Values(0, 1));